@@ -14,6 +14,7 @@ import Joi from 'joi';
  * @property {string=} mqttPassword
  * @property {number} httpPort               - HTTP port (e.g., 3000)
  * @property {string} topicReadingPattern    - Glob/regex for sensor topic
+ * @property {string} topicBatchPattern      - Glob/regex for batched sensor topic (JSON array)
  */
 
 /** Validation schema for process.env. */
@@ -25,6 +26,7 @@ export const configSchema = Joi.object({
   MQTT_PASSWORD: Joi.string().optional(),
   HTTP_PORT: Joi.string().pattern(/^\d+$/).required(), // String containing a number
   TOPIC_READING_PATTERN: Joi.string().default('home/+/sensors/+/reading'),
+  TOPIC_BATCH_PATTERN: Joi.string().default('home/+/sensors/+/batch'),
 }).unknown(true);
 
 /**
@@ -65,6 +67,7 @@ export function loadConfig() {
     mqttUsername: value.MQTT_USERNAME,
     mqttPassword: value.MQTT_PASSWORD,
     httpPort: httpPort,
-    topicReadingPattern: value.TOPIC_READING_PATTERN
+    topicReadingPattern: value.TOPIC_READING_PATTERN,
+    topicBatchPattern: value.TOPIC_BATCH_PATTERN
   };
 }
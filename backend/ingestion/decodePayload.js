@@ -0,0 +1,125 @@
+/**
+ * @file Decode raw MQTT payloads (JSON or compact binary) → raw reading objects
+ */
+
+/** Version byte of the binary encoding (never '{' or '[' so JSON can be told apart) */
+export const BINARY_PAYLOAD_VERSION = 0x01;
+
+/**
+ * @typedef {Object} BinaryReading Reading decoded from a binary payload
+ * @property {number} temperature_c Temperature in Celsius (0.01 resolution)
+ * @property {number} humidity_pct Humidity percentage (0.01 resolution)
+ * @property {number} ts Unix timestamp in milliseconds (epoch ms UTC)
+ * @property {number} seq Device sequence number
+ */
+
+/**
+ * Decode an MQTT payload into the object(s) expected by ingestMessage
+ * Binary payloads on a reading topic must carry exactly one reading;
+ * on a batch topic they always decode to an array
+ * @param {string} topic - MQTT topic the payload was received on
+ * @param {Buffer} payload - Raw MQTT payload
+ * @returns {Object|Object[]} Raw reading object, or array for batches
+ * @throws {Error} if the payload cannot be decoded
+ * @example
+ * decodePayload('home/h1/sensors/temp001/reading', Buffer.from('{"temperature_c":23.5,"humidity_pct":65.2,"ts":1757442988279}'));
+ * // → { temperature_c: 23.5, humidity_pct: 65.2, ts: 1757442988279 }
+ */
+export function decodePayload(topic, payload) {
+  if (!isBinaryPayload(payload)) {
+    return JSON.parse(payload.toString());
+  }
+
+  const readings = decodeBinaryReadings(payload);
+  if (topic.endsWith('/batch')) {
+    return readings;
+  }
+
+  if (readings.length !== 1) {
+    throw new Error(`Binary reading payload must carry one reading (got ${readings.length})`);
+  }
+  return readings[0];
+}
+
+/**
+ * Check whether a payload uses the binary encoding
+ * @param {Buffer} payload - Raw MQTT payload
+ * @returns {boolean} true for a binary payload
+ */
+export function isBinaryPayload(payload) {
+  return payload.length > 0 && payload[0] === BINARY_PAYLOAD_VERSION;
+}
+
+/**
+ * Decode a binary payload (version 1, little-endian):
+ * u8 version, varint count, varint first seq, varint first ts (ms),
+ * then per reading: zigzag varint ts delta (absent for the first),
+ * i16 temperature (0.01 °C), i16 humidity (0.01 %)
+ * @param {Buffer} payload - Raw MQTT payload
+ * @returns {BinaryReading[]} Decoded readings, in payload order
+ * @throws {Error} if the payload is truncated, malformed or of an unknown version
+ */
+export function decodeBinaryReadings(payload) {
+  if (payload[0] !== BINARY_PAYLOAD_VERSION) {
+    throw new Error(`Unsupported binary payload version: ${payload[0]}`);
+  }
+
+  const cursor = { payload, offset: 1 };
+  const count = readVarint(cursor);
+  const firstSeq = readVarint(cursor);
+  let ts = readVarint(cursor);
+
+  if (count === 0) {
+    throw new Error('Binary payload carries no reading');
+  }
+
+  const readings = [];
+  for (let i = 0; i < count; i++) {
+    if (i > 0) {
+      const zigzag = readVarint(cursor);
+      ts += (zigzag % 2 === 0) ? zigzag / 2 : -(zigzag + 1) / 2;
+    }
+
+    if (cursor.offset + 4 > payload.length) {
+      throw new Error('Binary payload truncated');
+    }
+
+    readings.push({
+      temperature_c: payload.readInt16LE(cursor.offset) / 100,
+      humidity_pct: payload.readInt16LE(cursor.offset + 2) / 100,
+      ts,
+      seq: firstSeq + i
+    });
+    cursor.offset += 4;
+  }
+
+  if (cursor.offset !== payload.length) {
+    throw new Error('Binary payload has trailing bytes');
+  }
+
+  return readings;
+}
+
+/**
+ * Read an unsigned LEB128 varint (limited to safe JavaScript integers)
+ * @param {{payload: Buffer, offset: number}} cursor - Read position, advanced in place
+ * @returns {number} Decoded value
+ */
+function readVarint(cursor) {
+  let value = 0;
+  let factor = 1;
+
+  while (cursor.offset < cursor.payload.length) {
+    const byte = cursor.payload[cursor.offset++];
+    value += (byte & 0x7f) * factor;
+    if ((byte & 0x80) === 0) {
+      if (!Number.isSafeInteger(value)) {
+        throw new Error('Binary payload varint out of range');
+      }
+      return value;
+    }
+    factor *= 128;
+  }
+
+  throw new Error('Binary payload truncated');
+}
@@ -3,8 +3,9 @@
  */
 
 import { buildTopicParser } from './parseTopic.js';
-import { validateReading } from './validateReading.js';
+import { validateReading, validateReadingBatch } from './validateReading.js';
 import { ingestMessage } from './ingestMessage.js';
+import { decodePayload, decodeBinaryReadings, isBinaryPayload } from './decodePayload.js';
 
 // Create default parser with contract topic pattern
 const parseTopic = buildTopicParser('home/{homeId}/sensors/{deviceId}/reading');
@@ -13,5 +14,9 @@ export {
   buildTopicParser,
   parseTopic,
   validateReading,
-  ingestMessage
+  validateReadingBatch,
+  ingestMessage,
+  decodePayload,
+  decodeBinaryReadings,
+  isBinaryPayload
 };
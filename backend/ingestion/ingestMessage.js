@@ -4,25 +4,31 @@
  */
 
 import { buildTopicParser } from './parseTopic.js';
-import { validateReading } from './validateReading.js';
+import { validateReading, validateReadingBatch } from './validateReading.js';
 import crypto from 'crypto';
 
 // Create a parser for the standard MQTT topic pattern used in tests
 const parseTopic = buildTopicParser('home/{homeId}/sensors/{deviceId}/reading');
+// Batched readings (JSON array) are published on a sibling topic
+const parseBatchTopic = buildTopicParser('home/{homeId}/sensors/{deviceId}/batch');
 /**
  * @typedef {Object} IngestResult
  * @property {boolean} success - Whether ingestion succeeded
  * @property {string} deviceId - ID of the device that sent the message
  * @property {Object} reading - Normalized reading data
- * @property {number} insertId - Database row ID of inserted reading
+ * @property {number|null} insertId - Database row ID of inserted reading (null for a duplicate)
  * @property {boolean} deviceCreated - Always false (devices must be pre-provisioned)
  * @property {boolean} [retained] - Whether message was retained
+ * @property {boolean} [duplicate] - Single reading only: already stored (replay, QoS 1 redelivery)
+ * @property {Object[]} [readings] - Batch only: normalized readings, in payload order
+ * @property {number[]} [insertIds] - Batch only: database row IDs of inserted readings
+ * @property {number} [duplicates] - Batch only: readings already stored (replays)
  */
 
 /**
  * Ingest complete MQTT message through the full pipeline
  * @param {string} topic - MQTT topic (e.g. 'sensors/temp001/readings')
- * @param {Object} payload - Raw MQTT payload object
+ * @param {Object|Object[]} payload - Raw MQTT payload object (array for batch topics)
  * @param {Object} options - MQTT message options (retain, qos, etc.)
  * @param {Object} repository - Repository instance for database operations
  * @returns {Promise<IngestResult>} Result of ingestion with metadata
@@ -37,6 +43,11 @@ const parseTopic = buildTopicParser('home/{homeId}/sensors/{deviceId}/reading');
  * // → { success: true, deviceId: 'temp001', reading: {...}, insertId: 42 }
  */
 export async function ingestMessage(topic, payload, options = {}, repository) {
+  // Batched payloads take the array path
+  if (Array.isArray(payload)) {
+    return ingestBatch(topic, payload, options, repository);
+  }
+
   // Step 1: Parse MQTT topic to extract device information
   const parsedTopic = parseTopic(topic);
 
@@ -71,11 +82,20 @@ export async function ingestMessage(topic, payload, options = {}, repository) {
     msg_id: msgId
   };
 
-  // Step 6: Insert reading into database
-  const insertResult = await repository.readings.create(readingData);
+  // Step 6: Insert reading into database (a replayed reading is already stored)
+  let insertResult = null;
+  try {
+    insertResult = await repository.readings.create(readingData);
+  } catch (error) {
+    if (!isDuplicateReadingError(error)) {
+      throw error;
+    }
+  }
 
-  // Step 7: Update device last seen timestamp
-  await repository.devices.updateLastSeen(parsedTopic.deviceId, validatedReading.ts);
+  // Step 7: Update device last seen timestamp (a replay carries an older one)
+  if (insertResult) {
+    await repository.devices.updateLastSeen(parsedTopic.deviceId, validatedReading.ts);
+  }
 
   // Step 8: Return comprehensive result
   const result = {
@@ -86,10 +106,87 @@ export async function ingestMessage(topic, payload, options = {}, repository) {
       humidity: validatedReading.humidity,
       ts: validatedReading.ts
     },
-    insertId: insertResult.lastInsertRowid,
+    insertId: insertResult ? insertResult.lastInsertRowid : null,
     deviceCreated: false  // Devices are never auto-created, must be provisioned
   };
 
+  if (!insertResult) {
+    result.duplicate = true;
+  }
+
+  if (options.retain) {
+    result.retained = true;
+  }
+
+  return result;
+}
+
+/**
+ * Ingest a batch of readings published as one JSON array
+ * Readings already stored (store-and-forward replays) are counted, not rejected
+ * @param {string} topic - MQTT batch topic (home/{homeId}/sensors/{deviceId}/batch)
+ * @param {Object[]} payload - Raw readings, oldest first
+ * @param {Object} options - MQTT message options (retain, qos, etc.)
+ * @param {Object} repository - Repository instance for database operations
+ * @returns {Promise<IngestResult>} Result of ingestion with per-reading metadata
+ * @throws {Error} if the topic, the batch or the device is invalid
+ */
+async function ingestBatch(topic, payload, options, repository) {
+  const parsedTopic = parseBatchTopic(topic);
+  const validatedReadings = validateReadingBatch(payload);
+
+  const device = await repository.devices.findByUid(parsedTopic.deviceId);
+  if (!device) {
+    console.warn(`⚠️  Unknown device: ${parsedTopic.deviceId} - Message rejected. Device must be provisioned first.`);
+    throw new Error(`Device with UID ${parsedTopic.deviceId} not found. Device must be provisioned first.`);
+  }
+
+  // One placement lookup for the whole batch
+  const currentPlacement = await repository.devices.getCurrentPlacement(parsedTopic.deviceId);
+  const roomId = currentPlacement ? currentPlacement.room_id : null;
+
+  const insertIds = [];
+  let duplicates = 0;
+  let lastTs = validatedReadings[0].ts;
+
+  for (const validatedReading of validatedReadings) {
+    const readingData = {
+      uid: parsedTopic.deviceId,
+      room_id: roomId,
+      temperature: validatedReading.temperature,
+      humidity: validatedReading.humidity,
+      ts: validatedReading.ts,
+      source: 'mqtt',
+      msg_id: generateMessageId(parsedTopic.deviceId, validatedReading)
+    };
+
+    try {
+      const insertResult = await repository.readings.create(readingData);
+      insertIds.push(insertResult.lastInsertRowid);
+    } catch (error) {
+      if (!isDuplicateReadingError(error)) {
+        throw error;
+      }
+      duplicates++;
+    }
+
+    if (validatedReading.ts > lastTs) {
+      lastTs = validatedReading.ts;
+    }
+  }
+
+  await repository.devices.updateLastSeen(parsedTopic.deviceId, lastTs);
+
+  const result = {
+    success: true,
+    deviceId: parsedTopic.deviceId,
+    readings: validatedReadings,
+    insertIds,
+    insertId: insertIds.length > 0 ? insertIds[insertIds.length - 1] : null,
+    duplicates,
+    deviceCreated: false
+  };
+
   if (options.retain) {
     result.retained = true;
   }
@@ -97,6 +194,15 @@ export async function ingestMessage(topic, payload, options = {}, repository) {
   return result;
 }
 
+/**
+ * Check whether an insert failed because the reading is already stored (msg_id unique index)
+ * @param {Error} error - Error thrown by the repository
+ * @returns {boolean} true for a duplicate reading
+ */
+function isDuplicateReadingError(error) {
+  return error?.code === 'SQLITE_CONSTRAINT_UNIQUE';
+}
+
 /**
  * Generate consistent message ID for deduplication
  * @param {string} deviceId - Device identifier
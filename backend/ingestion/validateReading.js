@@ -17,6 +17,9 @@
  * @property {string} ts ISO timestamp string
  */
 
+/** Maximum number of readings accepted in one batch payload */
+export const MAX_BATCH_READINGS = 500;
+
 /**
  * Validate and transform MQTT sensor payload according to contract
  * @param {RawReading} payload - Raw MQTT payload
@@ -102,3 +105,41 @@ export function validateReading(payload) {
 
   return result;
 }
+
+/**
+ * Validate and transform a batched MQTT payload (JSON array of readings)
+ * @param {RawReading[]} payload - Raw readings published on the batch topic, oldest first
+ * @returns {ValidatedReading[]} Validated and normalized readings, in payload order
+ * @throws {Error} if the array is invalid or any reading is invalid (message prefixed with its index)
+ * @example
+ * const validated = validateReadingBatch([
+ *   { temperature_c: 23.7, humidity_pct: 52.5, ts: 1725427200000 },
+ *   { temperature_c: 23.8, humidity_pct: 52.4, ts: 1725427230000 }
+ * ]);
+ * // → [{ temperature: 23.7, ... }, { temperature: 23.8, ... }]
+ */
+export function validateReadingBatch(payload) {
+  if (payload === null || payload === undefined) {
+    throw new Error('Payload is required');
+  }
+
+  if (!Array.isArray(payload)) {
+    throw new Error('Batch payload must be an array');
+  }
+
+  if (payload.length === 0) {
+    throw new Error('Batch payload cannot be empty');
+  }
+
+  if (payload.length > MAX_BATCH_READINGS) {
+    throw new Error(`Batch payload too large (max ${MAX_BATCH_READINGS} readings)`);
+  }
+
+  return payload.map((reading, index) => {
+    try {
+      return validateReading(reading);
+    } catch (error) {
+      throw new Error(`Reading ${index}: ${error.message}`);
+    }
+  });
+}
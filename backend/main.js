@@ -11,7 +11,7 @@ import { isMainModule } from './is-main.js';
 import { logger } from './logger.js';
 import { healthMonitor } from './health.js';
 import { createRepository } from './repositories/index.js';
-import { ingestMessage } from './ingestion/index.js';
+import { ingestMessage, decodePayload, isBinaryPayload } from './ingestion/index.js';
 
 /**
  * Start the application.
@@ -45,8 +45,7 @@ export async function start() {
   // 4.1 Configurer l'ingestion MQTT → Base de données
   const unsubscribeIngestion = mqtt.onMessage(async (topic, payload, packet) => {
     try {
-      const payloadStr = payload.toString();
-      const payloadObj = JSON.parse(payloadStr);
+      const payloadObj = decodePayload(topic, payload);
 
       const result = await ingestMessage(topic, payloadObj, {
         retain: packet.retain,
@@ -57,7 +56,9 @@ export async function start() {
         topic,
         deviceId: result.deviceId,
         deviceCreated: result.deviceCreated,
-        insertId: result.insertId
+        insertId: result.insertId,
+        ...(result.duplicate && { duplicate: true }),
+        ...(result.readings && { readings: result.readings.length, duplicates: result.duplicates })
       });
 
       // Incrémenter les métriques
@@ -67,7 +68,7 @@ export async function start() {
       logger.error('MQTT ingestion failed', {
         topic,
         error: error.message,
-        payload: payload.toString()
+        payload: isBinaryPayload(payload) ? payload.toString('hex') : payload.toString()
       });
       healthMonitor.incrementMetric('errors');
     }
@@ -75,7 +76,11 @@ export async function start() {
 
   // 4.2 S'abonner au pattern de topics configuré
   await mqtt.subscribe(config.topicReadingPattern);
-  logger.info('MQTT subscribed to topics', { pattern: config.topicReadingPattern });
+  await mqtt.subscribe(config.topicBatchPattern);
+  logger.info('MQTT subscribed to topics', {
+    pattern: config.topicReadingPattern,
+    batchPattern: config.topicBatchPattern
+  });
 
   // 5. Démarrer le serveur HTTP
   const httpServer = createHttpServer({
@@ -0,0 +1,649 @@
+/**
+ * @file bench_device.c
+ * @brief Microbenchmark suite of the device hot paths
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Logging, publish payload formatting, raw count conversions, config
+ * parsing and string helpers, in a simulation build (no sensor, no broker).
+ * The batch frame decoder is first checked against the float conversions
+ * over every 20-bit count (exit status 1 on a mismatch).
+ * Each benchmark runs once to warm up, then BENCH_RUNS times; the fastest
+ * run is kept. CPU cycles come from perf_event_open() when the kernel
+ * allows it (kernel.perf_event_paranoid), otherwise only ns/op is given.
+ *
+ * Results: table on stdout, JSON with -o (one result per line) to keep
+ * for comparison across commits, -b to compare with such a file.
+ * Build and run with: make bench [BASELINE=previous.json]
+ */
+
+#define _GNU_SOURCE  // Pour syscall(), mkstemp() et getopt()
+#include "common.h"
+#include "aht20.h"
+#include "aht20_emulator.h"
+#include "config.h"
+#include "mqtt_client.h"
+#include "payload_codec.h"
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <math.h>
+
+#define BENCH_RUNS         5
+#define BENCH_MAX_RESULTS  32
+#define BENCH_NAME_MAX     64
+#define RAW_SAMPLES        1024   // Power of two (index mask)
+#define DECODE_TOLERANCE   0.01   // Integer path vs float output (°C, %RH)
+
+typedef struct {
+    const char* name;
+    uint64_t iterations;
+    void (*setup)(void);             // Optional, not timed
+    void (*run)(uint64_t iterations);
+    void (*teardown)(void);          // Optional, not timed
+} bench_t;
+
+typedef struct {
+    char name[BENCH_NAME_MAX];
+    uint64_t iterations;
+    double ns_per_op;
+    double cycles_per_op;            // < 0: not measured
+} bench_result_t;
+
+static volatile uint64_t sink;       // Keeps the compiler from dropping the work
+static volatile float float_sink;
+
+static int cycles_fd = -1;
+static const char* cycles_scope = "none";
+
+static uint32_t raw_temperature[RAW_SAMPLES];
+static uint32_t raw_humidity[RAW_SAMPLES];
+static sensor_reading_t readings[RAW_SAMPLES];
+static uint8_t raw_frames[RAW_SAMPLES * AHT20_FRAME_LENGTH];
+static int32_t decoded_temperature[RAW_SAMPLES];
+static int32_t decoded_humidity[RAW_SAMPLES];
+static uint8_t decoded_valid[RAW_SAMPLES];
+static char config_path[] = "/tmp/techtemp-bench-XXXXXX";
+static device_config_t loaded_config;
+
+static bench_result_t results[BENCH_MAX_RESULTS];
+static int result_count = 0;
+static bench_result_t baseline[BENCH_MAX_RESULTS];
+static int baseline_count = 0;
+
+// Internal helper functions
+static void cycles_open(void);
+static uint64_t cycles_read(void);
+static uint64_t now_ns(void);
+static void measure(const bench_t* bench);
+static int write_large_config(void);
+static void pack_frame(uint8_t* frame, uint8_t status, uint32_t raw_humidity, uint32_t raw_temperature);
+static int check_decoder(void);
+static int verify_decoder(uint8_t* frames, uint8_t* short_frames, int32_t* temperature, int32_t* humidity,
+                          uint8_t* valid, size_t count);
+static int load_baseline(const char* path);
+static const bench_result_t* baseline_find(const char* name);
+static void print_results(const char* revision);
+static int write_json(const char* path, const char* revision);
+
+// Logging: synchronous path to /dev/null, asynchronous ring, filtered level
+
+static void log_burst(log_level_t level, uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        log_write(level, __FILE__, __LINE__, "Sensor %s: T %.2f°C, H %.2f%%, seq %llu",
+                  "bench", 21.5, 45.25, (unsigned long long)i);
+    }
+}
+
+static void log_all_levels(void) {
+    log_set_level(LOG_LEVEL_DEBUG);
+}
+
+static void log_errors_only(void) {
+    log_set_level(LOG_LEVEL_ERROR);
+}
+
+static void log_async_start(void) {
+    log_set_level(LOG_LEVEL_DEBUG);
+    log_start_async(true);
+}
+
+static void log_async_stop(void) {
+    log_cleanup();  // Drains the ring (not timed)
+    log_init(LOG_LEVEL_ERROR, "/dev/null", false);
+}
+
+static void bench_log_filtered(uint64_t iterations) { log_burst(LOG_LEVEL_DEBUG, iterations); }
+static void bench_log_debug(uint64_t iterations) { log_burst(LOG_LEVEL_DEBUG, iterations); }
+static void bench_log_info(uint64_t iterations) { log_burst(LOG_LEVEL_INFO, iterations); }
+static void bench_log_warn(uint64_t iterations) { log_burst(LOG_LEVEL_WARN, iterations); }
+static void bench_log_error(uint64_t iterations) { log_burst(LOG_LEVEL_ERROR, iterations); }
+
+// Payload formatting, alone and through mqtt_publish_reading()
+
+static void bench_payload_json(uint64_t iterations) {
+    char buffer[PAYLOAD_READING_JSON_MAX];
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink += (uint64_t)payload_encode_json(buffer, sizeof(buffer), &readings[i & (RAW_SAMPLES - 1)]);
+    }
+}
+
+static void bench_payload_binary(uint64_t iterations) {
+    uint8_t buffer[PAYLOAD_READING_JSON_MAX];
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink += (uint64_t)payload_encode_binary(buffer, sizeof(buffer), &readings[i & (RAW_SAMPLES - 1)], 1);
+    }
+}
+
+static void mqtt_start(payload_format_t format) {
+    mqtt_config_t config = {
+        .port = 1883,
+        .qos = 1,
+        .keepalive = 60,
+        .connect_timeout_ms = 5000,
+        .payload_format = format
+    };
+    strcpy(config.host, "localhost");
+    strcpy(config.client_id, "techtemp-bench");
+    strcpy(config.topic, "home/bench/sensors/bench/reading");
+    if (mqtt_init(&config) != TECHTEMP_OK || mqtt_connect() != TECHTEMP_OK) {
+        fprintf(stderr, "Simulated MQTT client unavailable: %s\n", mqtt_get_error());
+    }
+}
+
+static void mqtt_start_json(void) { mqtt_start(PAYLOAD_FORMAT_JSON); }
+static void mqtt_start_binary(void) { mqtt_start(PAYLOAD_FORMAT_BINARY); }
+
+static void bench_publish_reading(uint64_t iterations) {
+    int mid = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink += (uint64_t)mqtt_publish_reading(&readings[i & (RAW_SAMPLES - 1)], NULL, &mid);
+    }
+}
+
+// Raw count conversions: float (reading->temperature) and fixed-point
+
+static void bench_calculate_temperature(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        float_sink = aht20_calculate_temperature(raw_temperature[i & (RAW_SAMPLES - 1)]);
+    }
+}
+
+static void bench_calculate_humidity(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        float_sink = aht20_calculate_humidity(raw_humidity[i & (RAW_SAMPLES - 1)]);
+    }
+}
+
+static void bench_temperature_centi(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = (uint64_t)aht20_temperature_centi(raw_temperature[i & (RAW_SAMPLES - 1)]);
+    }
+}
+
+static void bench_humidity_centi(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = (uint64_t)aht20_humidity_centi(raw_humidity[i & (RAW_SAMPLES - 1)]);
+    }
+}
+
+// Full measurement against the emulated sensor (conversion time, bus time)
+
+static aht20_t emulated_sensor;
+
+static void emulated_start(void) {
+    aht20_emulator_config_t emulator_cfg = {
+        .conversion_ms = 80,
+        .bus_khz = 100,
+        .period_seconds = 86400,
+        .seed = 1
+    };
+    log_errors_only();
+    aht20_emulator_configure(&emulator_cfg);
+    aht20_set_transport(&aht20_emulator_transport);
+    if (aht20_init(&emulated_sensor, 1, AHT20_DEFAULT_ADDRESS) != TECHTEMP_OK) {
+        fprintf(stderr, "Emulated AHT20 init failed\n");
+    }
+}
+
+static void emulated_stop(void) {
+    aht20_cleanup(&emulated_sensor);
+}
+
+static void bench_read_emulated(uint64_t iterations) {
+    sensor_reading_t reading;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink += (uint64_t)aht20_read(&emulated_sensor, &reading);
+    }
+}
+
+// Batch decoder: RAW_SAMPLES frames per call, ns/op per frame
+
+static void decode_batches(uint64_t iterations, uint8_t* valid) {
+    for (uint64_t done = 0; done < iterations; done += RAW_SAMPLES) {
+        size_t count = iterations - done < RAW_SAMPLES ? (size_t)(iterations - done) : RAW_SAMPLES;
+        sink += aht20_decode_frames(raw_frames, AHT20_FRAME_LENGTH, count,
+                                    decoded_temperature, decoded_humidity, valid);
+    }
+}
+
+static void bench_decode_frames(uint64_t iterations) { decode_batches(iterations, NULL); }
+static void bench_decode_frames_checked(uint64_t iterations) { decode_batches(iterations, decoded_valid); }
+
+// Config file: every section, MAX_SENSORS [sensor.*] sections, comments
+
+static void bench_config_load(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink += (uint64_t)config_load(config_path, &loaded_config);
+    }
+}
+
+// String helpers (str_trim includes restoring its input)
+
+static void bench_str_trim(uint64_t iterations) {
+    static const char input[] = "  broker.local.lan \t\r\n";
+    char buffer[sizeof(input)];
+    for (uint64_t i = 0; i < iterations; i++) {
+        memcpy(buffer, input, sizeof(input));
+        sink += (uint64_t)strlen(str_trim(buffer));
+    }
+}
+
+static void bench_str_to_bool(uint64_t iterations) {
+    static const char* const inputs[] = { "true", " yes ", "OFF", "0", "maybe" };
+    bool value = false;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink += (uint64_t)str_to_bool(inputs[i % 5], &value) + value;
+    }
+}
+
+static const bench_t benchmarks[] = {
+    { "log_write.filtered",           5000000, log_errors_only,   bench_log_filtered,          NULL },
+    { "log_write.debug",               200000, log_all_levels,    bench_log_debug,             log_errors_only },
+    { "log_write.info",                200000, log_all_levels,    bench_log_info,              log_errors_only },
+    { "log_write.warn",                200000, log_all_levels,    bench_log_warn,              log_errors_only },
+    { "log_write.error",               200000, log_all_levels,    bench_log_error,             log_errors_only },
+    { "log_write.info.async",          200000, log_async_start,   bench_log_info,              log_async_stop },
+    { "payload.json",                 2000000, NULL,              bench_payload_json,          NULL },
+    { "payload.binary",               2000000, NULL,              bench_payload_binary,        NULL },
+    { "mqtt_publish_reading.json",    1000000, mqtt_start_json,   bench_publish_reading,       mqtt_cleanup },
+    { "mqtt_publish_reading.binary",  1000000, mqtt_start_binary, bench_publish_reading,       mqtt_cleanup },
+    { "aht20.calculate_temperature", 20000000, NULL,              bench_calculate_temperature, NULL },
+    { "aht20.calculate_humidity",    20000000, NULL,              bench_calculate_humidity,    NULL },
+    { "aht20.temperature_centi",     20000000, NULL,              bench_temperature_centi,     NULL },
+    { "aht20.humidity_centi",        20000000, NULL,              bench_humidity_centi,        NULL },
+    { "aht20.decode_frames",         20000000, NULL,              bench_decode_frames,         NULL },
+    { "aht20.decode_frames.checked", 20000000, NULL,              bench_decode_frames_checked, NULL },
+    { "aht20_read.emulated",                5, emulated_start,    bench_read_emulated,         emulated_stop },
+    { "config_load.large",               2000, NULL,              bench_config_load,           NULL },
+    { "str_trim",                     5000000, NULL,              bench_str_trim,              NULL },
+    { "str_to_bool",                  2000000, NULL,              bench_str_to_bool,           NULL },
+};
+
+static void usage(const char* program) {
+    printf("Usage: %s [-o results.json] [-b baseline.json] [-r revision] [-f filter]\n", program);
+    printf("  -o  Write the results as JSON\n");
+    printf("  -b  Compare ns/op with a previous JSON result file\n");
+    printf("  -r  Revision recorded in the results (e.g. git describe)\n");
+    printf("  -f  Only run benchmarks whose name contains this string\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* output_path = NULL;
+    const char* baseline_path = NULL;
+    const char* revision = "unknown";
+    const char* filter = NULL;
+    
+    int option;
+    while ((option = getopt(argc, argv, "o:b:r:f:h")) != -1) {
+        switch (option) {
+            case 'o': output_path = optarg; break;
+            case 'b': baseline_path = optarg; break;
+            case 'r': revision = optarg[0] != '\0' ? optarg : "unknown"; break;
+            case 'f': filter = optarg; break;
+            case 'h': usage(argv[0]); return EXIT_SUCCESS;
+            default: usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+    
+    if (baseline_path && load_baseline(baseline_path) != TECHTEMP_OK) {
+        fprintf(stderr, "Cannot read baseline %s\n", baseline_path);
+        return EXIT_FAILURE;
+    }
+    
+    // Library logging goes nowhere unless a benchmark enables it
+    log_init(LOG_LEVEL_ERROR, "/dev/null", false);
+    
+    // Spread of plausible raw counts (about 15-30 °C, 30-70 %)
+    for (int i = 0; i < RAW_SAMPLES; i++) {
+        raw_temperature[i] = 340000u + (uint32_t)i * 80u;
+        raw_humidity[i] = 315000u + (uint32_t)i * 400u;
+        readings[i] = (sensor_reading_t){
+            .temperature = aht20_calculate_temperature(raw_temperature[i]),
+            .humidity = aht20_calculate_humidity(raw_humidity[i]),
+            .temperature_centi = aht20_temperature_centi(raw_temperature[i]),
+            .humidity_centi = aht20_humidity_centi(raw_humidity[i]),
+            .timestamp = 1725427200000ULL + (uint64_t)i * 1000,
+            .seq = (uint64_t)i,
+            .valid = true
+        };
+        pack_frame(raw_frames + i * AHT20_FRAME_LENGTH, AHT20_STATUS_CALIBRATED, raw_humidity[i], raw_temperature[i]);
+    }
+    
+    if (check_decoder() != TECHTEMP_OK) {
+        return EXIT_FAILURE;
+    }
+    
+    if (write_large_config() != TECHTEMP_OK) {
+        fprintf(stderr, "Cannot write the benchmark config: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    
+    cycles_open();
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        if (!filter || strstr(benchmarks[i].name, filter)) {
+            measure(&benchmarks[i]);
+        }
+    }
+    
+    unlink(config_path);
+    log_cleanup();
+    if (cycles_fd >= 0) {
+        close(cycles_fd);
+    }
+    
+    print_results(revision);
+    if (output_path && write_json(output_path, revision) != TECHTEMP_OK) {
+        fprintf(stderr, "Cannot write %s: %s\n", output_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Internal helper functions
+
+static void cycles_open(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_hv = 1;
+    
+    // This thread only; kernel cycles (log writes) when allowed, user only otherwise
+    attr.exclude_kernel = 0;
+    cycles_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (cycles_fd >= 0) {
+        cycles_scope = "all";
+        return;
+    }
+    attr.exclude_kernel = 1;
+    cycles_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (cycles_fd >= 0) {
+        cycles_scope = "user";
+    }
+}
+
+static uint64_t cycles_read(void) {
+    uint64_t count = 0;
+    if (cycles_fd < 0 || read(cycles_fd, &count, sizeof(count)) != sizeof(count)) {
+        return 0;
+    }
+    return count;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void measure(const bench_t* bench) {
+    if (result_count >= BENCH_MAX_RESULTS) {
+        return;
+    }
+    
+    uint64_t best_ns = UINT64_MAX;
+    uint64_t best_cycles = 0;
+    for (int run = -1; run < BENCH_RUNS; run++) {
+        if (bench->setup) {
+            bench->setup();
+        }
+        
+        // Run -1: warm-up (caches, branch predictors, first-use allocations)
+        uint64_t iterations = run < 0 ? bench->iterations / 10 + 1 : bench->iterations;
+        uint64_t start_cycles = cycles_read();
+        uint64_t start_ns = now_ns();
+        bench->run(iterations);
+        uint64_t elapsed_ns = now_ns() - start_ns;
+        uint64_t elapsed_cycles = cycles_read() - start_cycles;
+        
+        if (bench->teardown) {
+            bench->teardown();
+        }
+        if (run >= 0 && elapsed_ns < best_ns) {
+            best_ns = elapsed_ns;
+            best_cycles = elapsed_cycles;
+        }
+    }
+    
+    bench_result_t* result = &results[result_count++];
+    snprintf(result->name, sizeof(result->name), "%s", bench->name);
+    result->iterations = bench->iterations;
+    result->ns_per_op = (double)best_ns / (double)bench->iterations;
+    result->cycles_per_op = cycles_fd >= 0 ? (double)best_cycles / (double)bench->iterations : -1.0;
+}
+
+static void pack_frame(uint8_t* frame, uint8_t status, uint32_t raw_humidity, uint32_t raw_temperature) {
+    frame[0] = status;
+    frame[1] = (uint8_t)(raw_humidity >> 12);
+    frame[2] = (uint8_t)(raw_humidity >> 4);
+    frame[3] = (uint8_t)(((raw_humidity & 0x0F) << 4) | (raw_temperature >> 16));
+    frame[4] = (uint8_t)(raw_temperature >> 8);
+    frame[5] = (uint8_t)raw_temperature;
+    frame[6] = aht20_crc8(frame, AHT20_FRAME_LENGTH - 1);
+}
+
+static int check_decoder(void) {
+    // Every 20-bit count, as humidity and (reversed) as temperature
+    const size_t count = (size_t)1 << 20;
+    uint8_t* frames = malloc(count * AHT20_FRAME_LENGTH);
+    uint8_t* short_frames = malloc(count * (AHT20_FRAME_LENGTH - 1));
+    int32_t* temperature = malloc(count * sizeof(int32_t));
+    int32_t* humidity = malloc(count * sizeof(int32_t));
+    uint8_t* valid = malloc(count);
+    
+    int result = TECHTEMP_ERROR;
+    if (frames && short_frames && temperature && humidity && valid) {
+        result = verify_decoder(frames, short_frames, temperature, humidity, valid, count);
+    } else {
+        fprintf(stderr, "Decoder check: out of memory\n");
+    }
+    
+    free(frames);
+    free(short_frames);
+    free(temperature);
+    free(humidity);
+    free(valid);
+    return result;
+}
+
+static int verify_decoder(uint8_t* frames, uint8_t* short_frames, int32_t* temperature, int32_t* humidity,
+                          uint8_t* valid, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        pack_frame(frames + i * AHT20_FRAME_LENGTH, AHT20_STATUS_CALIBRATED,
+                   (uint32_t)i, (uint32_t)(count - 1 - i));
+        memcpy(short_frames + i * (AHT20_FRAME_LENGTH - 1), frames + i * AHT20_FRAME_LENGTH, AHT20_FRAME_LENGTH - 1);
+    }
+    
+    // Two invalid frames: busy bit, then one flipped data bit (CRC mismatch)
+    frames[1 * AHT20_FRAME_LENGTH] |= AHT20_STATUS_BUSY;
+    frames[2 * AHT20_FRAME_LENGTH + 4] ^= 0x10;
+    size_t valid_count = aht20_decode_frames(frames, AHT20_FRAME_LENGTH, count, temperature, humidity, valid);
+    if (valid_count != count - 2 || !valid[0] || valid[1] || valid[2]) {
+        fprintf(stderr, "Decoder check: %zu valid frames of %zu, expected %zu\n", valid_count, count, count - 2);
+        return TECHTEMP_ERROR;
+    }
+    
+    double max_temperature = 0.0, max_humidity = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        if (i == 2) {
+            continue;  // Corrupted on purpose
+        }
+        uint32_t raw_humidity = (uint32_t)i;
+        uint32_t raw_temperature = (uint32_t)(count - 1 - i);
+        if (temperature[i] != aht20_temperature_centi(raw_temperature) ||
+            humidity[i] != aht20_humidity_centi(raw_humidity)) {
+            fprintf(stderr, "Decoder check: frame %zu differs from the scalar conversions\n", i);
+            return TECHTEMP_ERROR;
+        }
+        
+        double temperature_error = fabs(temperature[i] / 100.0 - aht20_calculate_temperature(raw_temperature));
+        double humidity_error = fabs(humidity[i] / 100.0 - aht20_calculate_humidity(raw_humidity));
+        max_temperature = fmax(max_temperature, temperature_error);
+        max_humidity = fmax(max_humidity, humidity_error);
+    }
+    if (max_temperature > DECODE_TOLERANCE || max_humidity > DECODE_TOLERANCE) {
+        fprintf(stderr, "Decoder check: max difference %.4f °C, %.4f %%RH (tolerance %.2f)\n",
+                max_temperature, max_humidity, DECODE_TOLERANCE);
+        return TECHTEMP_ERROR;
+    }
+    
+    // 6-byte frames (no CRC) decode to the same values
+    aht20_decode_frames(short_frames, AHT20_FRAME_LENGTH - 1, count, temperature, humidity, NULL);
+    for (size_t i = 0; i < count; i++) {
+        if (temperature[i] != aht20_temperature_centi((uint32_t)(count - 1 - i)) ||
+            humidity[i] != aht20_humidity_centi((uint32_t)i)) {
+            fprintf(stderr, "Decoder check: 6-byte frame %zu differs from the scalar conversions\n", i);
+            return TECHTEMP_ERROR;
+        }
+    }
+    
+    printf("Decoder check: %zu counts, max difference %.4f °C, %.4f %%RH (tolerance %.2f)\n",
+           count, max_temperature, max_humidity, DECODE_TOLERANCE);
+    return TECHTEMP_OK;
+}
+
+static int write_large_config(void) {
+    int fd = mkstemp(config_path);
+    if (fd < 0) {
+        return TECHTEMP_ERROR;
+    }
+    FILE* file = fdopen(fd, "w");
+    if (!file) {
+        close(fd);
+        unlink(config_path);
+        return TECHTEMP_ERROR;
+    }
+    
+    static const char* const sections[] = {
+        "[device]\ndevice_uid = aht20-b827eb123456\nhome_id = home-001\nlabel = \"Capteur AHT20 Bench\"\n",
+        "[sensor]\ni2c_address = 0x38\ni2c_bus = 1\nread_interval_seconds = 300\n"
+        "temperature_offset = 0.0\nhumidity_offset = 0.0\nschedule_mode = spread\n"
+        "oversampling = 4\noversampling_filter = median\ndeadband_temperature = 0.1\n"
+        "deadband_humidity = 0.5\nheartbeat_seconds = 900\n",
+        "[mqtt]\nbroker_host = 192.168.0.180\nbroker_port = 1883\nusername = \npassword = \n"
+        "qos = 1\nretain = false\nkeepalive_seconds = 60\n"
+        "reconnect_delay_seconds = 5\nreconnect_max_delay_seconds = 300\nbatch_size = 8\n"
+        "batch_max_latency_ms = 5000\n",
+        "[queue]\nqueue_capacity = 256\n",
+        "[logging]\nlog_level = info\nlog_to_console = true\nlog_async = true\n",
+        "[system]\ndaemon_mode = false\npid_file = /run/techtemp-device.pid\nrealtime = false\n",
+    };
+    for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); i++) {
+        for (int line = 0; line < 8; line++) {
+            fprintf(file, "# Commentaire de documentation de la section, ligne %d : valeurs et unités\n", line);
+        }
+        fprintf(file, "%s\n", sections[i]);
+    }
+    
+    // Behind TCA9548A multiplexers: 8 channels at each of 0x70-0x73
+    for (int sensor = 0; sensor < MAX_SENSORS; sensor++) {
+        fprintf(file, "# Capteur %d : pièce, étage, remarque d'installation\n", sensor);
+        fprintf(file, "[sensor.piece%02d]\nmux_address = 0x%02X\nmux_channel = %d\n"
+                      "temperature_offset = -0.25\nhumidity_offset = 1.5\n\n",
+                sensor, 0x70 + sensor / 8, sensor % 8);
+    }
+    
+    return fclose(file) == 0 ? TECHTEMP_OK : TECHTEMP_ERROR;
+}
+
+static int load_baseline(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return TECHTEMP_ERROR;
+    }
+    
+    // One result per line, as written by write_json()
+    char line[256];
+    while (baseline_count < BENCH_MAX_RESULTS && fgets(line, sizeof(line), file)) {
+        bench_result_t* entry = &baseline[baseline_count];
+        unsigned long long iterations;
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"iterations\": %llu, \"ns_per_op\": %lf",
+                   entry->name, &iterations, &entry->ns_per_op) == 3) {
+            entry->iterations = iterations;
+            baseline_count++;
+        }
+    }
+    fclose(file);
+    return baseline_count > 0 ? TECHTEMP_OK : TECHTEMP_ERROR;
+}
+
+static const bench_result_t* baseline_find(const char* name) {
+    for (int i = 0; i < baseline_count; i++) {
+        if (strcmp(baseline[i].name, name) == 0) {
+            return &baseline[i];
+        }
+    }
+    return NULL;
+}
+
+static void print_results(const char* revision) {
+    printf("TechTemp device benchmarks (revision %s, best of %d runs, cycles: %s)\n",
+           revision, BENCH_RUNS, cycles_scope);
+    printf("%-30s %10s %10s %10s%s\n", "benchmark", "iterations", "ns/op", "cycles/op",
+           baseline_count > 0 ? "    vs base" : "");
+    
+    for (int i = 0; i < result_count; i++) {
+        const bench_result_t* result = &results[i];
+        printf("%-30s %10llu %10.1f ", result->name, (unsigned long long)result->iterations, result->ns_per_op);
+        if (result->cycles_per_op >= 0) {
+            printf("%10.1f", result->cycles_per_op);
+        } else {
+            printf("%10s", "-");
+        }
+        
+        const bench_result_t* base = baseline_find(result->name);
+        if (base && base->ns_per_op > 0) {
+            printf("    %+6.1f%%", (result->ns_per_op / base->ns_per_op - 1.0) * 100.0);
+        } else if (baseline_count > 0) {
+            printf("    %7s", "new");
+        }
+        printf("\n");
+    }
+}
+
+static int write_json(const char* path, const char* revision) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return TECHTEMP_ERROR;
+    }
+    
+    fprintf(file, "{\n  \"suite\": \"techtemp-device\",\n  \"revision\": \"%s\",\n"
+                  "  \"runs\": %d,\n  \"cycles\": \"%s\",\n  \"results\": [\n",
+            revision, BENCH_RUNS, cycles_scope);
+    for (int i = 0; i < result_count; i++) {
+        const bench_result_t* result = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"cycles_per_op\": ",
+                result->name, (unsigned long long)result->iterations, result->ns_per_op);
+        if (result->cycles_per_op >= 0) {
+            fprintf(file, "%.2f}", result->cycles_per_op);
+        } else {
+            fprintf(file, "null}");
+        }
+        fprintf(file, "%s\n", i + 1 < result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    
+    return fclose(file) == 0 ? TECHTEMP_OK : TECHTEMP_ERROR;
+}
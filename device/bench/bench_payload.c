@@ -0,0 +1,103 @@
+/**
+ * @file bench_payload.c
+ * @brief Microbenchmark of the reading publish formatting path
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Compares the former snprintf("%.2f") JSON formatting from float values
+ * with the integer fixed-point path (raw counts -> hundredths -> encoder).
+ * Build and run with: make bench-payload
+ */
+
+#define _DEFAULT_SOURCE  // Pour CLOCK_MONOTONIC
+#include "common.h"
+#include "aht20.h"
+#include "payload_codec.h"
+#include <math.h>
+
+#define BENCH_ITERATIONS 1000000
+#define RAW_SAMPLES      1024
+
+static volatile size_t sink;  // Keeps the compiler from dropping the work
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void report(const char* name, uint64_t elapsed_ns) {
+    printf("%-28s %8.1f ns/op\n", name, (double)elapsed_ns / BENCH_ITERATIONS);
+}
+
+int main(void) {
+    uint32_t raw_temperature[RAW_SAMPLES];
+    uint32_t raw_humidity[RAW_SAMPLES];
+    uint64_t timestamp = 1725427200000ULL;
+    char buffer[PAYLOAD_READING_JSON_MAX];
+    
+    // Spread of plausible raw counts (about 15-30 °C, 30-70 %)
+    for (int i = 0; i < RAW_SAMPLES; i++) {
+        raw_temperature[i] = 340000u + (uint32_t)i * 80u;
+        raw_humidity[i] = 315000u + (uint32_t)i * 400u;
+    }
+    
+    // Former path: float conversion + snprintf("%.2f")
+    uint64_t start = now_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = i & (RAW_SAMPLES - 1);
+        float temperature = ((float)raw_temperature[n] * 200.0 / 0x100000) - 50.0;
+        float humidity = ((float)raw_humidity[n] * 100.0) / 0x100000;
+        sink += (size_t)snprintf(buffer, sizeof(buffer),
+                                 "{\"temperature_c\":%.2f,\"humidity_pct\":%.2f,\"ts\":%lu}",
+                                 temperature, humidity, (unsigned long)(timestamp + (uint64_t)i));
+    }
+    uint64_t snprintf_ns = now_ns() - start;
+    
+    // Fixed-point path: raw counts -> hundredths -> integer encoder
+    start = now_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = i & (RAW_SAMPLES - 1);
+        sensor_reading_t reading = {
+            .temperature_centi = aht20_temperature_centi(raw_temperature[n]),
+            .humidity_centi = aht20_humidity_centi(raw_humidity[n]),
+            .timestamp = timestamp + (uint64_t)i
+        };
+        sink += (size_t)payload_encode_json(buffer, sizeof(buffer), &reading);
+    }
+    uint64_t fixed_ns = now_ns() - start;
+    
+    // Binary encoding for comparison
+    start = now_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = i & (RAW_SAMPLES - 1);
+        sensor_reading_t reading = {
+            .temperature_centi = aht20_temperature_centi(raw_temperature[n]),
+            .humidity_centi = aht20_humidity_centi(raw_humidity[n]),
+            .timestamp = timestamp + (uint64_t)i,
+            .seq = (uint64_t)i
+        };
+        sink += (size_t)payload_encode_binary((uint8_t*)buffer, sizeof(buffer), &reading, 1);
+    }
+    uint64_t binary_ns = now_ns() - start;
+    
+    // Both paths must print the same values (within one hundredth)
+    int mismatches = 0;
+    for (int n = 0; n < RAW_SAMPLES; n++) {
+        float temperature = ((float)raw_temperature[n] * 200.0 / 0x100000) - 50.0;
+        float humidity = ((float)raw_humidity[n] * 100.0) / 0x100000;
+        if (labs(lroundf(temperature * 100.0f) - aht20_temperature_centi(raw_temperature[n])) > 1 ||
+            labs(lroundf(humidity * 100.0f) - aht20_humidity_centi(raw_humidity[n])) > 1) {
+            mismatches++;
+        }
+    }
+    
+    printf("Payload formatting, %d iterations\n", BENCH_ITERATIONS);
+    report("snprintf %.2f (float)", snprintf_ns);
+    report("fixed-point JSON (raw)", fixed_ns);
+    report("fixed-point binary (raw)", binary_ns);
+    printf("Speedup JSON: %.1fx, conversion mismatches: %d\n",
+           (double)snprintf_ns / (double)fixed_ns, mismatches);
+    
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
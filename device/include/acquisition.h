@@ -0,0 +1,91 @@
+/**
+ * @file acquisition.h
+ * @brief Pipelined multi-sensor acquisition for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * One acquisition cycle triggers every sensor of a bus first, waits for a
+ * single conversion window (~80 ms) and then collects all results, instead
+ * of paying the conversion time once per sensor. Each /dev/i2c-N bus is
+ * driven by its own worker thread, so buses convert in parallel and the
+ * cycle time stays roughly constant as sensors are added. Completion is
+ * reported to the event loop through an eventfd; the readings themselves
+ * travel through a wait-free single-producer/single-consumer ring per bus,
+ * so a slow network never holds a lock the sampling needs.
+ *
+ * In real-time mode the cycles are started by a SCHED_FIFO pacer thread
+ * sleeping on absolute clock_nanosleep() deadlines instead of the event
+ * loop timer, so publishing never delays a sample.
+ *
+ * With oversampling, a cycle runs K such rounds spread evenly over the
+ * first half of the interval (absolute deadlines, so the sensor is never
+ * kept converting: self-heating would bias the result) and reduces the K
+ * samples of each sensor (median or trimmed mean, in hundredths) into the
+ * single reading that gets published.
+ */
+
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include "common.h"
+
+// Readings handed to the event loop: one wait-free SPSC ring per bus
+// (power of two, room for a few cycles of MAX_SENSORS readings)
+#define ACQUISITION_RING_SLOTS    64
+
+// Real-time mode: stack of the acquisition threads (locked by mlockall)
+#define ACQUISITION_RT_STACK_SIZE (256 * 1024)
+
+// Integrity: a rejected measurement (I/O error, CRC, status) is repeated up
+// to this many times in the same cycle, then the sensor is soft reset
+#define ACQUISITION_RETRY_BUDGET  2
+
+// Receives one reading of acquisition_drain() (event loop thread)
+typedef void (*acquisition_reading_cb_t)(int sensor_index, sensor_reading_t* reading);
+
+/**
+ * Start one worker thread per I2C bus of the sensor registry
+ * (call after sensor_registry_init). In real-time mode, also start the
+ * SCHED_FIFO pacer thread that starts the cycles on absolute deadlines
+ * @param config Device configuration (oversampling and real-time settings)
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int acquisition_init(const device_config_t* config);
+
+/**
+ * Get the completion file descriptor
+ * Becomes readable when a bus has pushed the readings of a cycle
+ * @return eventfd to watch in the event loop, or -1 if not initialized
+ */
+int acquisition_get_fd(void);
+
+/**
+ * Start a cycle over all available sensors (returns immediately);
+ * each bus records the delay of its first trigger after deadline_us
+ * in the sample jitter histogram
+ * @param deadline_us Intended start time (CLOCK_MONOTONIC microseconds)
+ * @return TECHTEMP_OK if started, TECHTEMP_ERROR if a cycle is still running
+ */
+int acquisition_start_cycle(uint64_t deadline_us);
+
+/**
+ * Check whether a cycle is running
+ * @return true until every bus worker has finished the last cycle
+ */
+bool acquisition_busy(void);
+
+/**
+ * Hand the readings waiting in the rings to a callback, oldest first per bus
+ * (call when the eventfd is readable; sensors that could not be read
+ * during a cycle have no reading)
+ * @param callback Receives each reading with its sensor index in the registry
+ * @return Number of readings handed
+ */
+int acquisition_drain(acquisition_reading_cb_t callback);
+
+/**
+ * Stop the worker threads (waits for a running cycle to end)
+ */
+void acquisition_cleanup(void);
+
+#endif // ACQUISITION_H
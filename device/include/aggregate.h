@@ -0,0 +1,118 @@
+/**
+ * @file aggregate.h
+ * @brief Windowed on-device aggregation for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Streaming min/max/mean/count of the readings of a sensor over fixed
+ * wall-clock windows (1 min, 1 h, ...), aligned on multiples of the window
+ * like the backend hour/day buckets. Each window keeps O(1) state per
+ * metric (min, max, sum in hundredths); a bucket is closed by the first
+ * reading of the next one and waits in a small ring until the broker
+ * acknowledged it on the aggregate topic (PUBACK), like the readings of
+ * the store-and-forward queue. The ring is in memory only: pending
+ * buckets do not survive a restart.
+ */
+
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "common.h"
+
+#define AGGREGATE_PENDING_MAX  16   // Closed buckets kept while MQTT is down
+
+// Streaming state of one metric (hundredths)
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int64_t sum;
+} aggregate_metric_t;
+
+// One bucket: [start_ms, start_ms + window_s * 1000)
+typedef struct {
+    uint64_t start_ms;         // Unix ms, multiple of the window
+    uint32_t window_s;
+    uint32_t count;            // Readings in the bucket (0 = empty)
+    aggregate_metric_t temperature;
+    aggregate_metric_t humidity;
+} aggregate_bucket_t;
+
+// One aggregation window of a sensor
+typedef struct {
+    uint32_t window_s;
+    aggregate_bucket_t current;
+    aggregate_bucket_t pending[AGGREGATE_PENDING_MAX];
+    int pending_mid[AGGREGATE_PENDING_MAX];     // MQTT message id of a published bucket
+    bool pending_acked[AGGREGATE_PENDING_MAX];
+    int pending_first;
+    int pending_count;
+    int pending_sent;          // Oldest pending buckets published, waiting for their PUBACK
+    int early_ack_mid;         // QoS 0 ack delivered before aggregate_mark_sent()
+    uint32_t dropped;          // Closed buckets overwritten before being acknowledged
+} aggregate_window_t;
+
+/**
+ * Mean of a metric in hundredths, rounded (halves away from zero)
+ */
+static inline int32_t aggregate_mean_centi(const aggregate_metric_t* metric, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    int64_t half = (int64_t)(count / 2);
+    return (int32_t)((metric->sum >= 0 ? metric->sum + half : metric->sum - half) / (int64_t)count);
+}
+
+/**
+ * Initialize an aggregation window
+ * @param window Window to initialize
+ * @param window_s Window length in seconds
+ */
+void aggregate_init(aggregate_window_t* window, uint32_t window_s);
+
+/**
+ * Add a reading to its bucket (closes the current bucket when the
+ * reading belongs to another one)
+ * @param window Aggregation window
+ * @param reading Valid reading (offsets applied)
+ * @return true if a bucket was closed and is waiting to be published
+ */
+bool aggregate_add(aggregate_window_t* window, const sensor_reading_t* reading);
+
+/**
+ * Get the oldest closed bucket not published yet
+ * @param window Aggregation window
+ * @return Bucket, or NULL if none is waiting to be published
+ */
+const aggregate_bucket_t* aggregate_peek_unsent(const aggregate_window_t* window);
+
+/**
+ * Record that the bucket returned by aggregate_peek_unsent() was published
+ * @param window Aggregation window
+ * @param mid MQTT message id returned by the publish call
+ */
+void aggregate_mark_sent(aggregate_window_t* window, int mid);
+
+/**
+ * Retire the bucket published with the given message id (PUBACK received)
+ * @param window Aggregation window to look the message up in
+ * @param mid MQTT message id from the publish callback
+ * @return true if the message belonged to this window
+ */
+bool aggregate_ack(aggregate_window_t* window, int mid);
+
+/**
+ * Record an acknowledgement delivered before aggregate_mark_sent()
+ * (QoS 0 publish callback invoked from inside the publish call)
+ * @param window Aggregation window being published from
+ * @param mid MQTT message id from the publish callback
+ */
+void aggregate_ack_unsent(aggregate_window_t* window, int mid);
+
+/**
+ * Forget in-flight state after a disconnection: unacknowledged buckets
+ * will be published again, in order, after reconnection
+ * @param window Aggregation window to rewind
+ */
+void aggregate_rewind(aggregate_window_t* window);
+
+#endif // AGGREGATE_H
@@ -13,12 +13,16 @@
 #define AHT20_H
 
 #include "common.h"
+#include "i2c_transport.h"
 
 // AHT20 I2C constants
 #define AHT20_DEFAULT_ADDRESS   0x38
 #define AHT20_RESET_DELAY_MS    20
 #define AHT20_MEASURE_DELAY_MS  120
 #define AHT20_INIT_DELAY_MS     40
+#define AHT20_CONVERSION_TIME_MS 80     // Datasheet: measurement completes within ~80 ms
+#define AHT20_BUSY_RETRY_MS     10      // Re-check delay if still busy after the deadline
+#define AHT20_FRAME_LENGTH      7       // Status, 5 data bytes, CRC-8
 
 // AHT20 Commands
 #define AHT20_CMD_INIT          0xBE    // Initialize sensor
@@ -40,50 +44,202 @@
 #define AHT20_HUMIDITY_MAX      1048576.0f   // 2^20
 #define AHT20_TEMPERATURE_MAX   1048576.0f   // 2^20
 
+// Integrity counters of one sensor (since aht20_init)
+typedef struct {
+    uint32_t readings;         // Readings that passed the CRC and status checks
+    uint32_t crc_errors;       // Frame CRC-8 mismatch
+    uint32_t status_errors;    // Busy after completion, or calibration bit lost
+    uint32_t io_errors;        // Failed I2C transactions
+    uint32_t timeouts;         // Still busy after the retry budget
+    uint32_t resets;           // aht20_reset() calls
+} aht20_stats_t;
+
+// AHT20 sensor instance (one per physical sensor, see sensor_registry.h)
+typedef struct {
+    const i2c_transport_t* transport;  // i2c-dev or emulator (see aht20_set_transport)
+    int i2c_handle;
+    uint8_t address;
+    int timer_fd;              // Conversion deadline (trigger → poll_ready → collect)
+    bool initialized;
+    bool measuring;
+    bool deadline_reached;
+    bool calibration_reported; // Calibration bit set after init (checked on every frame)
+    int busy_polls;
+    uint8_t frame[AHT20_FRAME_LENGTH];  // Last frame read (I2C_RDWR, status first)
+    bool frame_ready;          // Frame of a completed measurement, not collected yet
+    int io_syscalls;           // I2C ioctls since the last trigger
+    int io_transactions;       // I2C bus transactions (START...STOP) since the last trigger
+    aht20_stats_t stats;
+    char last_error[256];
+} aht20_t;
+
+/**
+ * CRC-8 of an AHT20 frame (polynomial 0x31, initial value 0xFF)
+ */
+static inline uint8_t aht20_crc8(const uint8_t* data, int length) {
+    uint8_t crc = 0xFF;
+    for (int i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Calculate temperature from raw value (based on Adafruit formula)
+ * Single precision only: 200 / 2^20 is exact in a float, no double promotion
+ */
+static inline float aht20_calculate_temperature(uint32_t raw_temperature) {
+    return (float)raw_temperature * (200.0f / AHT20_TEMPERATURE_MAX) - 50.0f;
+}
+
+/**
+ * Calculate humidity from raw value (based on Adafruit formula)
+ */
+static inline float aht20_calculate_humidity(uint32_t raw_humidity) {
+    return (float)raw_humidity * (100.0f / AHT20_HUMIDITY_MAX);
+}
+
+/**
+ * Convert a raw 20-bit temperature count to hundredths of a degree Celsius
+ * Integer only: T = raw * 200 / 2^20 - 50 = raw * 625 / 2^15 - 50 (rounded)
+ */
+static inline int32_t aht20_temperature_centi(uint32_t raw_temperature) {
+    return (int32_t)((raw_temperature * 625u + (1u << 14)) >> 15) - 5000;
+}
+
+/**
+ * Convert a raw 20-bit humidity count to hundredths of a percent
+ * Integer only: H = raw * 100 / 2^20 = raw * 625 / 2^16 (rounded)
+ */
+static inline int32_t aht20_humidity_centi(uint32_t raw_humidity) {
+    return (int32_t)((raw_humidity * 625u + (1u << 15)) >> 16);
+}
+
+/**
+ * Decode a batch of raw frames (oversampling, burst reads) into
+ * structure-of-arrays outputs, integer arithmetic only
+ * @param frames Frames laid out back to back, status byte first
+ * @param frame_length Bytes per frame: 6 (no CRC) or AHT20_FRAME_LENGTH (CRC checked)
+ * @param count Number of frames
+ * @param temperature_centi Output, hundredths of a degree Celsius (count entries)
+ * @param humidity_centi Output, hundredths of a percent (count entries)
+ * @param valid Output, 1 if the frame is not busy and its CRC matches (count entries, may be NULL)
+ * @return Number of valid frames (count when valid is NULL, 0 on a bad frame_length)
+ */
+size_t aht20_decode_frames(const uint8_t* frames, size_t frame_length, size_t count,
+                           int32_t* restrict temperature_centi, int32_t* restrict humidity_centi,
+                           uint8_t* restrict valid);
+
+/**
+ * Select the I2C transport of the sensors initialized afterwards
+ * @param transport i2c_dev_transport (default) or aht20_emulator_transport
+ */
+void aht20_set_transport(const i2c_transport_t* transport);
+
 /**
  * Initialize AHT20 sensor
+ * @param sensor Sensor instance to initialize
  * @param i2c_bus I2C bus number (usually 1 on Raspberry Pi)
  * @param address I2C address of sensor (default 0x38)
  * @return TECHTEMP_OK on success, error code on failure
  */
-int aht20_init(int i2c_bus, uint8_t address);
+int aht20_init(aht20_t* sensor, int i2c_bus, uint8_t address);
+
+/**
+ * Read temperature and humidity from AHT20 (blocks during the conversion)
+ * @param sensor Sensor instance
+ * @param reading Pointer to sensor_reading_t structure to fill
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int aht20_read(aht20_t* sensor, sensor_reading_t* reading);
+
+/**
+ * Start a measurement without waiting for it to complete
+ * Arms the conversion timer (see aht20_get_timer_fd) to the datasheet conversion time
+ * @param sensor Sensor instance
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int aht20_trigger(aht20_t* sensor);
+
+/**
+ * Check whether the measurement started by aht20_trigger() is complete
+ * Nothing is read before the conversion deadline; then one I2C_RDWR
+ * transaction fetches the status, data and CRC bytes together
+ * @param sensor Sensor instance
+ * @param ready Pointer to bool set to true when data can be collected
+ * @return TECHTEMP_OK on success, TECHTEMP_TIMEOUT if the sensor stays busy, error code on failure
+ */
+int aht20_poll_ready(aht20_t* sensor, bool* ready);
 
 /**
- * Read temperature and humidity from AHT20
+ * Read the result of a completed measurement
+ * The frame is rejected (TECHTEMP_ERROR, counted in the stats) on a CRC
+ * mismatch, a busy status or a calibration bit lost since init
+ * @param sensor Sensor instance
  * @param reading Pointer to sensor_reading_t structure to fill
  * @return TECHTEMP_OK on success, error code on failure
  */
-int aht20_read(sensor_reading_t* reading);
+int aht20_collect(aht20_t* sensor, sensor_reading_t* reading);
+
+/**
+ * Abandon the measurement started by aht20_trigger() (disarms the conversion timer)
+ * @param sensor Sensor instance
+ */
+void aht20_cancel(aht20_t* sensor);
 
 /**
- * Perform soft reset of AHT20 sensor
+ * Get the conversion timer file descriptor
+ * Becomes readable when the pending measurement deadline expires (poll/epoll)
+ * @param sensor Sensor instance
+ * @return Timer file descriptor, or -1 if not initialized
+ */
+int aht20_get_timer_fd(const aht20_t* sensor);
+
+/**
+ * Perform soft reset of AHT20 sensor and re-initialize it
+ * (abandons a pending measurement; escalation after repeated failures)
+ * @param sensor Sensor instance
  * @return TECHTEMP_OK on success, error code on failure
  */
-int aht20_reset(void);
+int aht20_reset(aht20_t* sensor);
 
 /**
  * Check if AHT20 is busy (measurement in progress)
+ * @param sensor Sensor instance
  * @param busy Pointer to bool to store busy status
  * @return TECHTEMP_OK on success, error code on failure
  */
-int aht20_is_busy(bool* busy);
+int aht20_is_busy(aht20_t* sensor, bool* busy);
 
 /**
  * Check if AHT20 is calibrated and ready
+ * @param sensor Sensor instance
  * @param calibrated Pointer to bool to store calibration status
  * @return TECHTEMP_OK on success, error code on failure
  */
-int aht20_is_calibrated(bool* calibrated);
+int aht20_is_calibrated(aht20_t* sensor, bool* calibrated);
+
+/**
+ * Get the integrity counters
+ * @param sensor Sensor instance
+ * @return Counters since aht20_init
+ */
+const aht20_stats_t* aht20_get_stats(const aht20_t* sensor);
 
 /**
  * Close AHT20 sensor and cleanup resources
+ * @param sensor Sensor instance (initialized by aht20_init)
  */
-void aht20_cleanup(void);
+void aht20_cleanup(aht20_t* sensor);
 
 /**
  * Get last error message from AHT20 operations
+ * @param sensor Sensor instance
  * @return Pointer to error string
  */
-const char* aht20_get_error(void);
+const char* aht20_get_error(const aht20_t* sensor);
 
 #endif // AHT20_H
@@ -0,0 +1,59 @@
+/**
+ * @file aht20_emulator.h
+ * @brief Emulated AHT20 behind the I2C transport interface
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Answers the driver's transactions like the real sensor: soft reset and
+ * calibration commands, a conversion that keeps the busy bit set for a
+ * jittered conversion time (stale data meanwhile), frames with their
+ * CRC-8, and transfers that take their bus time. Temperature and humidity
+ * follow a daily-style sine wave plus noise, one phase per device.
+ * Faults are injected at configurable rates: NACK (EREMOTEIO), bus error
+ * (EIO), corrupted frame (CRC mismatch) and brown-out (calibration bit
+ * lost until the next soft reset).
+ *
+ * Used by default in simulation builds ([emulator] section of the config),
+ * so acquisition throughput, latency and recovery can be measured with no
+ * sensor attached. Each emulated device is only touched by the thread of
+ * its bus: no locking.
+ */
+
+#ifndef AHT20_EMULATOR_H
+#define AHT20_EMULATOR_H
+
+#include "common.h"
+#include "i2c_transport.h"
+
+// Waveform (mean ± amplitude over period_seconds)
+#define AHT20_EMULATOR_TEMPERATURE_MEAN       21.0f
+#define AHT20_EMULATOR_TEMPERATURE_AMPLITUDE  3.0f
+#define AHT20_EMULATOR_TEMPERATURE_NOISE      0.05f
+#define AHT20_EMULATOR_HUMIDITY_MEAN          45.0f
+#define AHT20_EMULATOR_HUMIDITY_AMPLITUDE     10.0f
+#define AHT20_EMULATOR_HUMIDITY_NOISE         0.2f
+#define AHT20_EMULATOR_RESET_MS               20      // Busy after a soft reset
+#define AHT20_EMULATOR_CALIBRATION_MS         10      // Busy after the calibration command
+
+typedef struct {
+    int conversion_ms;          // Nominal conversion time (datasheet: 80 ms)
+    int conversion_jitter_ms;   // Extra conversion time, uniform in [0, jitter]
+    int bus_khz;                // Bus clock for the transfer time (0 = instantaneous)
+    float nack_rate;            // Probability per transfer (0-1)
+    float error_rate;
+    float crc_error_rate;       // Probability per frame read
+    float brownout_rate;        // Probability per measurement
+    int period_seconds;         // Waveform period
+    uint32_t seed;              // Fault and noise sequence (same seed, same run)
+} aht20_emulator_config_t;
+
+// Transport answering as emulated AHT20 devices (one per open)
+extern const i2c_transport_t aht20_emulator_transport;
+
+/**
+ * Set the behaviour of the devices opened afterwards
+ * @param config Emulation settings
+ */
+void aht20_emulator_configure(const aht20_emulator_config_t* config);
+
+#endif // AHT20_EMULATOR_H
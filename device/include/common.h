@@ -37,6 +37,12 @@
 #define MAX_HOME_ID_LEN        32
 #define DEVICE_UID_LENGTH      16
 #define ISO8601_TIMESTAMP_SIZE 32
+#define MAX_SENSORS            32
+#define MAX_OVERSAMPLING       16
+#define OVERSAMPLING_ROUND_MS  100    // One pipelined conversion round (80 ms + I/O)
+#define OVERSAMPLING_MAX_DUTY  10     // Percent of the interval converting (AHT20 self-heating < 0.1 °C)
+#define MAX_AGGREGATE_WINDOWS  4
+#define MIN_STATS_INTERVAL     60   // Rate limit of the stats topic (seconds)
 
 // Logging levels
 typedef enum {
@@ -46,14 +52,47 @@ typedef enum {
     LOG_LEVEL_ERROR
 } log_level_t;
 
+// MQTT payload encodings
+typedef enum {
+    PAYLOAD_FORMAT_JSON = 0,   // Human readable, default
+    PAYLOAD_FORMAT_BINARY      // Compact versioned encoding (see mqtt_client.h)
+} payload_format_t;
+
+// Sampling schedules (see schedule.h)
+typedef enum {
+    SCHEDULE_FREE = 0,         // Period from process start
+    SCHEDULE_SPREAD,           // Wall-clock slot + per-device phase offset
+    SCHEDULE_BOUNDARY          // Sample at the slot boundary, publish after the offset
+} schedule_mode_t;
+
+// Oversampling reductions (see acquisition.h)
+typedef enum {
+    OVERSAMPLING_MEDIAN = 0,   // Median of the samples, default
+    OVERSAMPLING_TRIMMED_MEAN  // Mean without the lowest and highest quarter
+} oversampling_filter_t;
+
 // Sensor reading structure
 typedef struct {
     float temperature;      // Temperature in Celsius
     float humidity;        // Humidity in percentage
+    int32_t temperature_centi;  // Temperature in hundredths of a degree (fixed point)
+    int32_t humidity_centi;     // Humidity in hundredths of a percent (fixed point)
     uint64_t timestamp;    // Unix timestamp in milliseconds
+    uint64_t seq;          // Device sequence number (set by the reading queue)
     bool valid;            // Data validity flag
 } sensor_reading_t;
 
+// One sensor of the device ([sensor.<id>] section)
+typedef struct {
+    char id[MAX_DEVICE_UID_LEN];   // Published as the device_uid of its readings
+    int i2c_bus;
+    uint8_t i2c_address;
+    uint8_t mux_address;           // TCA9548A address (0 = sensor wired directly)
+    int mux_channel;               // Mux channel (0-7)
+    float temp_offset;
+    float humidity_offset;
+} sensor_config_t;
+
 // Device configuration structure  
 typedef struct {
     // Device info
@@ -68,6 +107,14 @@ typedef struct {
     int read_interval;
     float temp_offset;
     float humidity_offset;
+    schedule_mode_t schedule_mode;
+    int oversampling;                      // Samples per published reading (1 = off)
+    oversampling_filter_t oversampling_filter;
+    float deadband_temperature;            // Report by exception: min change to publish
+    float deadband_humidity;               // (0 = change not watched, both 0 = off)
+    int heartbeat_seconds;                 // Max silence with a deadband
+    sensor_config_t sensors[MAX_SENSORS];  // Without [sensor.*] sections: one sensor
+    int sensor_count;                      // built from the settings above
     
     // MQTT settings
     char mqtt_host[MAX_STRING_LEN];
@@ -77,18 +124,75 @@ typedef struct {
     int mqtt_qos;
     bool mqtt_retain;
     int mqtt_keepalive;
+    int mqtt_batch_size;            // Readings per message (1 = no batching)
+    int mqtt_batch_max_latency_ms;  // Max wait before a partial batch is sent
+    payload_format_t mqtt_payload_format;
+    int mqtt_reconnect_delay;       // Backoff base in seconds
+    int mqtt_reconnect_max_delay;   // Backoff cap in seconds
+    int mqtt_max_reconnect_attempts; // Failures before the client is recreated (0 = never)
+    int aggregate_windows[MAX_AGGREGATE_WINDOWS];  // Aggregation windows in seconds
+    int aggregate_window_count;     // 0 = no aggregates (-1 = invalid list)
+    bool publish_raw;               // Individual readings (false: aggregates only)
+    int stats_interval;             // Self-telemetry period in seconds (0 = disabled)
+    
+    // Store-and-forward queue settings
+    char queue_file[MAX_STRING_LEN];
+    int queue_capacity;
     
     // Logging settings
     log_level_t log_level;
     bool log_to_console;
     bool log_to_file;
     char log_file[MAX_STRING_LEN];
+    bool log_async;                 // Background writer thread (hot paths only enqueue)
+    bool log_block_when_full;       // Ring full: wait for the writer instead of dropping
+    char log_trace_file[MAX_STRING_LEN]; // Binary trace log (empty = disabled)
+    log_level_t log_trace_level;    // Lowest level recorded in the trace log
+    int log_trace_size_kb;          // Trace record ring size
     
     // System settings
     bool daemon_mode;
     char pid_file[MAX_STRING_LEN];
+    bool realtime;                  // Deterministic sampling: SCHED_FIFO pacer, mlockall
+    int realtime_cpu;               // CPU the acquisition threads are pinned to (-1 = any)
+    int realtime_priority;          // SCHED_FIFO priority (1-99)
+    char metrics_socket[MAX_STRING_LEN]; // OpenMetrics Unix socket (empty = disabled)
+    int metrics_port;               // OpenMetrics loopback TCP port (0 = disabled)
+    
+    // Emulated AHT20 sensors (see aht20_emulator.h)
+    bool emulator_enabled;          // Default in simulation builds
+    int emulator_conversion_ms;
+    int emulator_conversion_jitter_ms;
+    int emulator_bus_khz;           // 0 = instantaneous transfers
+    float emulator_nack_rate;       // Fault probabilities (0-1)
+    float emulator_error_rate;
+    float emulator_crc_error_rate;
+    float emulator_brownout_rate;
+    int emulator_period_seconds;    // Temperature/humidity waveform period
+    uint32_t emulator_seed;
 } device_config_t;
 
+// Metrics registry: counters, gauges and log-linear histograms
+#define MAX_METRICS               48
+#define METRIC_HISTOGRAM_BUCKETS  48    // 2 per power of two: [0], [1], [2], [3], [4-5], [6-7], ...
+
+typedef enum {
+    METRIC_COUNTER = 0,        // Monotonic total
+    METRIC_GAUGE,              // Current value
+    METRIC_HISTOGRAM           // Distribution of observations (unit in the name)
+} metric_type_t;
+
+// One metric (all fields updated with __atomic builtins, no lock)
+typedef struct {
+    const char* name;          // OpenMetrics name: techtemp_<what>_<unit>
+    const char* help;
+    metric_type_t type;
+    int64_t value;             // Counter, gauge
+    uint64_t count;            // Histogram: observations
+    uint64_t sum;              // Histogram: sum of the observed values
+    uint64_t buckets[METRIC_HISTOGRAM_BUCKETS];  // Histogram: per bucket (not cumulative)
+} metric_t;
+
 // Global variables
 extern volatile bool g_running;      // Application running flag
 extern device_config_t g_config;    // Global configuration
@@ -103,8 +207,25 @@ int log_init(log_level_t level, const char* log_file_path, bool console_output);
 void log_set_level(log_level_t level);
 log_level_t log_get_level(void);
 void log_write(log_level_t level, const char* file, int line, const char* format, ...);
+int log_start_async(bool block_when_full);
+uint64_t log_dropped(void);
 void log_cleanup(void);
 
+// Metrics functions (register during initialization; updates from any thread;
+// a NULL metric is ignored so a failed registration never breaks a hot path)
+metric_t* metric_register(const char* name, const char* help, metric_type_t type);
+void metric_inc(metric_t* metric);
+void metric_add(metric_t* metric, int64_t delta);
+void metric_set(metric_t* metric, int64_t value);
+void metric_observe(metric_t* metric, uint64_t value);
+int64_t metric_value(const metric_t* metric);                  // Counter, gauge (0 if NULL)
+uint64_t metric_percentile(const metric_t* metric, int percent); // Histogram bucket bound (0 if empty)
+int metric_count(void);
+const metric_t* metric_get(int index);
+const metric_t* metric_find(const char* name);                  // NULL if not registered
+uint64_t metric_bucket_bound(int bucket);  // Inclusive upper bound (UINT64_MAX for the last)
+void metrics_log(void);
+
 // String utilities
 char* str_trim(char* str);
 int str_iequals(const char* str1, const char* str2);
@@ -119,8 +240,8 @@ const char* get_home_directory(void);
 // Device utilities
 int generate_device_uid(char* uid_buffer, size_t buffer_size);
 
-// Signal handling
-void setup_signal_handlers(void);
+// Signal handling (returns a signalfd for the event loop, -1 on failure)
+int setup_signal_handlers(void);
 void signal_handler(int signum);
 
 // Error handling macros
@@ -0,0 +1,102 @@
+/**
+ * @file event_loop.h
+ * @brief Single-threaded epoll reactor for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Multiplexes the MQTT socket, timers (timerfd) and signals (signalfd)
+ * so that the process only wakes up when something actually happens
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "common.h"
+#include <sys/epoll.h>
+
+// Maximum number of watched file descriptors
+#define EVENT_LOOP_MAX_WATCHES  16
+
+/**
+ * Event handler callback
+ * @param fd File descriptor that became ready
+ * @param events Ready events (EPOLLIN, EPOLLOUT, EPOLLERR, ...)
+ * @param ctx User context given to event_loop_add
+ */
+typedef void (*event_handler_t)(int fd, uint32_t events, void* ctx);
+
+/**
+ * Initialize the event loop
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int event_loop_init(void);
+
+/**
+ * Watch a file descriptor
+ * @param fd File descriptor to watch
+ * @param events Events of interest (EPOLLIN, EPOLLOUT)
+ * @param handler Callback invoked when the descriptor is ready
+ * @param ctx User context passed to the callback
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int event_loop_add(int fd, uint32_t events, event_handler_t handler, void* ctx);
+
+/**
+ * Change the events of interest for a watched file descriptor
+ * @param fd Watched file descriptor
+ * @param events New events of interest
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int event_loop_modify(int fd, uint32_t events);
+
+/**
+ * Stop watching a file descriptor (safe to call from a handler)
+ * @param fd Watched file descriptor
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int event_loop_remove(int fd);
+
+/**
+ * Wait for events and dispatch them to their handlers
+ * @param timeout_ms Maximum wait in milliseconds (-1 = until an event occurs)
+ * @return Number of dispatched events, or TECHTEMP_ERROR on failure
+ */
+int event_loop_run_once(int timeout_ms);
+
+/**
+ * Release the event loop resources (watched descriptors are not closed)
+ */
+void event_loop_cleanup(void);
+
+/**
+ * Create a non-blocking CLOCK_MONOTONIC timer file descriptor
+ * @return Timer file descriptor, or -1 on failure
+ */
+int timer_fd_create(void);
+
+/**
+ * Arm a timer file descriptor
+ * @param fd Timer file descriptor
+ * @param initial_ms First expiration in milliseconds (0 = disarm)
+ * @param interval_ms Period in milliseconds (0 = one-shot)
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int timer_fd_arm_ms(int fd, uint64_t initial_ms, uint64_t interval_ms);
+
+/**
+ * Arm a one-shot timer file descriptor at an absolute CLOCK_MONOTONIC time
+ * (fires immediately if the deadline is already past)
+ * @param fd Timer file descriptor
+ * @param deadline_ms Monotonic deadline in milliseconds
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int timer_fd_arm_abs_ms(int fd, uint64_t deadline_ms);
+
+/**
+ * Consume pending expirations of a timer file descriptor
+ * @param fd Timer file descriptor
+ * @return Number of expirations since the last call (0 if none)
+ */
+uint64_t timer_fd_consume(int fd);
+
+#endif // EVENT_LOOP_H
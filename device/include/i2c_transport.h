@@ -0,0 +1,42 @@
+/**
+ * @file i2c_transport.h
+ * @brief I2C transport used by the AHT20 driver
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * The driver talks to its sensor through this table of functions: the
+ * Linux i2c-dev character device on hardware, or an emulated AHT20
+ * (aht20_emulator.h) to exercise the timing and error paths without one.
+ */
+
+#ifndef I2C_TRANSPORT_H
+#define I2C_TRANSPORT_H
+
+#include "common.h"
+
+typedef struct {
+    const char* name;
+
+    /**
+     * Open the bus for one device
+     * @return Handle (>= 0), or -1 with errno set
+     */
+    int (*open)(int i2c_bus, uint8_t address);
+
+    /**
+     * One transaction: optional write, then optional read after a repeated
+     * start (a single START...STOP on the bus)
+     * @return 0 on success, -1 with errno set (EREMOTEIO: not acknowledged)
+     */
+    int (*transfer)(int handle, uint8_t address, uint8_t* tx, int tx_length, uint8_t* rx, int rx_length);
+
+    /**
+     * Release the handle
+     */
+    void (*close)(int handle);
+} i2c_transport_t;
+
+// /dev/i2c-<bus> with I2C_RDWR (unavailable in simulation builds)
+extern const i2c_transport_t i2c_dev_transport;
+
+#endif // I2C_TRANSPORT_H
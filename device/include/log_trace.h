@@ -0,0 +1,138 @@
+/**
+ * @file log_trace.h
+ * @brief Binary trace log for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Deferred logging: a traced LOG_*_F call stores its call-site id, a
+ * monotonic timestamp and its raw arguments in an mmap'd ring file,
+ * without any printf formatting. techtemp-logdump formats the records
+ * offline. Meant to keep DEBUG detail recorded on the fleet for
+ * post-mortems while the text log stays at a quieter level.
+ */
+
+#ifndef LOG_TRACE_H
+#define LOG_TRACE_H
+
+#include "common.h"
+#include <stdarg.h>
+
+/*
+ * File layout:
+ *   log_trace_header_t                       (96 bytes)
+ *   log_trace_site_t[LOG_TRACE_MAX_SITES]    (256 bytes each)
+ *   data ring                                (header.data_size bytes)
+ *
+ * Ring records, little-endian, not aligned:
+ *   u16  site id (or LOG_TRACE_SITE_PADDING / LOG_TRACE_SITE_EPOCH)
+ *   u16  record length, header included
+ *   u64  CLOCK_MONOTONIC timestamp (ns)
+ *   one argument per conversion of the site format, in order:
+ *     '*' width/precision, integers, pointers: 8 bytes (sign-extended)
+ *     floating point: 8-byte double
+ *     %s: u8 length, then the bytes (no terminator)
+ * An epoch record carries a u64 CLOCK_REALTIME reference (Unix ms) taken
+ * at its timestamp, written each time the file is opened; the header keeps
+ * the last one evicted by the ring. A record never wraps: the end of the
+ * ring is skipped with a padding record, or implicitly when fewer than
+ * LOG_TRACE_RECORD_HEADER bytes are left.
+ */
+#define LOG_TRACE_MAGIC          0x474C5454u  // "TTLG"
+#define LOG_TRACE_VERSION        1
+#define LOG_TRACE_MAX_SITES      1024
+#define LOG_TRACE_FILE_MAX       56      // Source file name (basename)
+#define LOG_TRACE_FORMAT_MAX     192     // Longer formats are logged as text only
+#define LOG_TRACE_STRING_MAX     128     // Longer %s arguments are truncated
+#define LOG_TRACE_RECORD_HEADER  12
+#define LOG_TRACE_RECORD_MAX     512
+#define LOG_TRACE_SITE_PADDING   0xFFFF
+#define LOG_TRACE_SITE_EPOCH     0xFFFE
+
+// On-disk header (96 bytes)
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t max_sites;
+    uint32_t site_count;
+    uint64_t data_size;       // Ring size in bytes
+    uint64_t head;            // Ring offset of the next record
+    uint64_t tail;            // Ring offset of the oldest record
+    uint64_t used;            // Bytes between tail and head
+    uint64_t dropped;         // Calls that could not be traced
+    uint64_t epoch_monotonic_ns;  // Last epoch record evicted from the ring:
+    uint64_t epoch_realtime_ms;   // clock reference of the oldest records
+    uint8_t reserved[24];
+} log_trace_header_t;
+
+// On-disk call site (256 bytes)
+typedef struct {
+    uint32_t line;
+    uint8_t level;            // log_level_t
+    uint8_t reserved[3];
+    char file[LOG_TRACE_FILE_MAX];
+    char format[LOG_TRACE_FORMAT_MAX];
+} log_trace_site_t;
+
+// Argument kinds of a printf conversion
+typedef enum {
+    LOG_ARG_NONE,             // "%%"
+    LOG_ARG_INT,              // d i c (and hh/h), signed
+    LOG_ARG_UINT,             // u o x X (and hh/h)
+    LOG_ARG_LONG,
+    LOG_ARG_ULONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_ULLONG,
+    LOG_ARG_SIZE,             // z
+    LOG_ARG_INTMAX,           // j
+    LOG_ARG_PTRDIFF,          // t
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LONG_DOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER,
+    LOG_ARG_INVALID           // Unsupported conversion (%n, unknown)
+} log_arg_kind_t;
+
+// One printf conversion specification
+typedef struct {
+    const char* start;        // The '%'
+    size_t length;            // Length of the specification text
+    int stars;                // '*' width/precision arguments (0-2)
+    log_arg_kind_t kind;
+} log_trace_conversion_t;
+
+// Lowest traced level (INT_MAX while tracing is off), checked by log_write()
+extern int log_trace_threshold;
+
+/**
+ * Open (or create) the trace file and start tracing
+ * @param path Trace file path
+ * @param size_kb Size of the record ring in KiB
+ * @param level Lowest level recorded (independent of the text log level)
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int log_trace_open(const char* path, int size_kb, log_level_t level);
+
+/**
+ * Record one log call (called by log_write(), level already filtered)
+ * @param level Message level
+ * @param file Source file (__FILE__)
+ * @param line Source line (__LINE__)
+ * @param format printf format, a string literal (its address is the call-site key)
+ * @param args Format arguments
+ */
+void log_trace_record(log_level_t level, const char* file, int line, const char* format, va_list args);
+
+/**
+ * Find the next conversion specification in a printf format
+ * @param format Format text to scan
+ * @param conversion Filled with the conversion found
+ * @return Pointer just past the conversion, or NULL when there is none left
+ */
+const char* log_trace_next_conversion(const char* format, log_trace_conversion_t* conversion);
+
+/**
+ * Stop tracing, flush and close the trace file
+ */
+void log_trace_close(void);
+
+#endif // LOG_TRACE_H
@@ -0,0 +1,38 @@
+/**
+ * @file metrics_server.h
+ * @brief OpenMetrics exporter for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Serves the metrics registry (see common.h) in the OpenMetrics text
+ * format to a local scraper (Prometheus, node_exporter proxy, curl) over
+ * a Unix domain socket and/or a loopback TCP port. Minimal HTTP/1.0: one
+ * GET /metrics per connection, answered from the main event loop without
+ * any thread, and rendered into a static buffer (no allocation).
+ * One scrape is served at a time; a new connection replaces a stalled one.
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include "common.h"
+
+#define METRICS_SERVER_BUFFER_SIZE  (64 * 1024)  // Response (headers + exposition)
+#define METRICS_SERVER_REQUEST_MAX  1024         // Request headers kept (the rest is ignored)
+#define METRICS_SERVER_BACKLOG      4
+
+/**
+ * Start listening and watch the sockets in the event loop
+ * (call after event_loop_init)
+ * @param socket_path Unix socket path (NULL or empty = none)
+ * @param port Loopback TCP port (0 = none)
+ * @return TECHTEMP_OK on success (or nothing to serve), error code on failure
+ */
+int metrics_server_start(const char* socket_path, int port);
+
+/**
+ * Close the sockets (and remove the Unix socket file)
+ */
+void metrics_server_stop(void);
+
+#endif // METRICS_SERVER_H
@@ -12,6 +12,8 @@
 #define MQTT_CLIENT_H
 
 #include "common.h"
+#include "aggregate.h"
+#include "payload_codec.h"
 #ifdef SIMULATION_MODE
     // Forward declaration for simulation
     struct mosquitto;
@@ -27,9 +29,11 @@ typedef struct {
     char username[256];
     char password[256];
     char topic[512];
+    char batch_topic[512];
     int qos;
     int keepalive;
     int connect_timeout_ms;
+    payload_format_t payload_format;
     bool use_tls;
     char ca_cert_path[256];
 } mqtt_config_t;
@@ -37,8 +41,10 @@ typedef struct {
 // MQTT client constants
 #define MQTT_CLIENT_ID_PREFIX   "techtemp-device-"
 #define MQTT_TOPIC_TEMPLATE     "home/%s/sensors/%s/reading"
-#define MQTT_PAYLOAD_TEMPLATE   "{\"temperature_c\":%.2f,\"humidity_pct\":%.2f,\"ts\":%llu}"
-
+#define MQTT_BATCH_TOPIC_TEMPLATE "home/%s/sensors/%s/batch"
+#define MQTT_AGGREGATE_TOPIC_TEMPLATE "home/%s/sensors/%s/aggregate"
+#define MQTT_STATS_TOPIC_TEMPLATE "home/%s/sensors/%s/stats"   // Device-level: device_uid as sensor
+#define MQTT_BATCH_MAX_READINGS 64      // Upper bound for batch_size
 // Connection states
 typedef enum {
     MQTT_DISCONNECTED = 0,
@@ -47,6 +53,9 @@ typedef enum {
     MQTT_ERROR
 } mqtt_state_t;
 
+// Publish acknowledgement callback (PUBACK for QoS 1, sent for QoS 0)
+typedef void (*mqtt_publish_cb_t)(int mid);
+
 // MQTT client context
 typedef struct {
     struct mosquitto* client;
@@ -65,11 +74,31 @@ typedef struct {
 int mqtt_init(const mqtt_config_t* config);
 
 /**
- * Connect to MQTT broker
- * @return TECHTEMP_OK on success, error code on failure
+ * Start connecting to the MQTT broker (non-blocking)
+ * The handshake completes in the event loop through mqtt_handle_events();
+ * mqtt_is_connecting() stays true until the broker answers or the socket fails
+ * @return TECHTEMP_OK if the attempt was started, error code on failure
  */
 int mqtt_connect(void);
 
+/**
+ * Check if a connection attempt is waiting for the broker
+ * @return true while the CONNACK is pending
+ */
+bool mqtt_is_connecting(void);
+
+/**
+ * Give up on the current connection attempt (connect timeout)
+ */
+void mqtt_abort_connect(void);
+
+/**
+ * Recreate the underlying client with the current configuration
+ * (recovers from a stuck libmosquitto state without restarting the process)
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int mqtt_reinit(void);
+
 /**
  * Disconnect from MQTT broker
  * @return TECHTEMP_OK on success, error code on failure
@@ -79,17 +108,72 @@ int mqtt_disconnect(void);
 /**
  * Publish sensor reading to MQTT broker
  * @param reading Sensor reading data to publish
- * @param device_uid Device unique identifier
+ * @param topic Topic of the sensor (NULL = configured topic)
+ * @param mid_out Optional pointer to store the MQTT message id
  * @return TECHTEMP_OK on success, error code on failure
  */
-int mqtt_publish_reading(const sensor_reading_t* reading, const char* device_uid);
+int mqtt_publish_reading(const sensor_reading_t* reading, const char* topic, int* mid_out);
+
+/**
+ * Publish several readings as one message on the batch topic
+ * (JSON array, or one binary payload carrying all readings, see payload_codec.h)
+ * @param readings Readings to publish, oldest first
+ * @param count Number of readings (1..MQTT_BATCH_MAX_READINGS)
+ * @param topic Batch topic of the sensor (NULL = configured batch topic)
+ * @param mid_out Optional pointer to store the MQTT message id
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int mqtt_publish_batch(const sensor_reading_t* readings, int count, const char* topic, int* mid_out);
+
+/**
+ * Publish a closed aggregation bucket (always JSON, see payload_codec.h)
+ * @param bucket Bucket to publish
+ * @param topic Aggregate topic of the sensor
+ * @param mid_out Optional pointer to store the MQTT message id
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int mqtt_publish_aggregate(const aggregate_bucket_t* bucket, const char* topic, int* mid_out);
+
+/**
+ * Publish a self-telemetry snapshot (always JSON, see payload_codec.h)
+ * @param stats Snapshot to publish
+ * @param topic Stats topic of the device
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int mqtt_publish_stats(const device_stats_t* stats, const char* topic);
+
+/**
+ * Register a callback invoked when a published message is acknowledged
+ * @param callback Function receiving the message id (NULL to disable)
+ */
+void mqtt_set_publish_callback(mqtt_publish_cb_t callback);
+
+/**
+ * Get the MQTT socket to watch in the event loop
+ * @return Socket file descriptor, or -1 if not connected
+ */
+int mqtt_get_socket(void);
+
+/**
+ * Check if outgoing data is waiting to be written to the socket
+ * @return true if the socket should be watched for writability
+ */
+bool mqtt_want_write(void);
+
+/**
+ * Handle socket readiness reported by the event loop
+ * @param readable Socket is readable
+ * @param writable Socket is writable
+ * @return TECHTEMP_OK on success, error code on failure (connection lost)
+ */
+int mqtt_handle_events(bool readable, bool writable);
 
 /**
- * Process MQTT events (call regularly in main loop)
- * @param timeout_ms Timeout for processing in milliseconds
+ * Run periodic MQTT housekeeping (keepalive pings)
+ * Must be called several times per keepalive interval
  * @return TECHTEMP_OK on success, error code on failure
  */
-int mqtt_loop(int timeout_ms);
+int mqtt_handle_misc(void);
 
 /**
  * Check if MQTT client is connected
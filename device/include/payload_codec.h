@@ -0,0 +1,123 @@
+/**
+ * @file payload_codec.h
+ * @brief MQTT payload encoders for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Allocation-free encoders for the publish hot path. Values are written
+ * from the fixed-point (hundredths) fields of sensor_reading_t with
+ * integer arithmetic only: no printf family, no locale, no float.
+ */
+
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include "common.h"
+#include "aggregate.h"
+
+/*
+ * Binary payload, version 1 (payload_format = binary), little-endian:
+ *   u8      version (0x01, never '{' or '[' so the backend can sniff it)
+ *   varint  number of readings N
+ *   varint  sequence number of the first reading (next ones are +1)
+ *   varint  timestamp of the first reading (Unix ms)
+ *   N times:
+ *     varint  zigzag timestamp delta from the previous reading (absent for the first)
+ *     i16     temperature in hundredths of a degree Celsius
+ *     i16     relative humidity in hundredths of a percent
+ * Varints are LEB128 (7 bits per byte, low bits first).
+ */
+#define PAYLOAD_BINARY_VERSION     0x01
+#define PAYLOAD_VARINT_MAX         10      // Bytes of a 64-bit varint
+#define PAYLOAD_READING_BINARY_MAX (PAYLOAD_VARINT_MAX + 4)
+#define PAYLOAD_BINARY_HEADER_MAX  (1 + 3 * PAYLOAD_VARINT_MAX)
+
+// Worst-case size of one JSON reading object
+#define PAYLOAD_READING_JSON_MAX   96
+
+// Worst-case size of one JSON aggregate object
+#define PAYLOAD_AGGREGATE_JSON_MAX 256
+
+// Worst-case size of one JSON stats object
+#define PAYLOAD_STATS_JSON_MAX     512
+
+// Self-telemetry snapshot of the device (stats topic), totals since start
+typedef struct {
+    uint64_t timestamp;            // Unix ms
+    uint64_t uptime_s;
+    uint64_t readings;             // Valid readings taken, all sensors
+    uint64_t published;            // Readings acknowledged by the broker
+    uint64_t suppressed;           // Readings inside the deadband
+    uint64_t dropped;              // Readings lost (acquisition rings and full queues)
+    uint64_t publish_latency_p50_us;
+    uint64_t publish_latency_p99_us;
+    uint64_t i2c_errors;           // I/O, CRC, status errors and timeouts
+    uint64_t reconnects;
+    uint64_t rss_kb;               // Resident set size
+    uint64_t cpu_ms;               // User + system CPU time
+    uint64_t queue_depth;          // Readings waiting in the queues
+} device_stats_t;
+
+/**
+ * Encode one reading as a JSON object:
+ * {"temperature_c":23.45,"humidity_pct":52.10,"ts":1725427200000}
+ * @param buffer Output buffer (not NUL-terminated)
+ * @param size Buffer size (PAYLOAD_READING_JSON_MAX is always enough)
+ * @param reading Reading to encode
+ * @return Number of bytes written, or -1 if the buffer is too small
+ */
+int payload_encode_json(char* buffer, size_t size, const sensor_reading_t* reading);
+
+/**
+ * Encode a closed aggregation bucket as a JSON object (ts = bucket start,
+ * temperature_c / humidity_pct = means, like the backend hour/day points):
+ * {"ts":1725426000000,"window_s":3600,"count":60,"temperature_c":23.45,
+ *  "temperature_min_c":22.90,"temperature_max_c":24.10,"humidity_pct":52.10,
+ *  "humidity_min_pct":50.00,"humidity_max_pct":55.30}
+ * @param buffer Output buffer (not NUL-terminated)
+ * @param size Buffer size (PAYLOAD_AGGREGATE_JSON_MAX is always enough)
+ * @param bucket Bucket to encode (count > 0)
+ * @return Number of bytes written, or -1 if the buffer is too small
+ */
+int payload_encode_aggregate_json(char* buffer, size_t size, const aggregate_bucket_t* bucket);
+
+/**
+ * Encode a stats snapshot as a flat JSON object of integers:
+ * {"ts":1725427200000,"uptime_s":86400,"readings":1440,"published":1438,
+ *  "suppressed":0,"dropped":0,"publish_latency_p50_us":1535,
+ *  "publish_latency_p99_us":6143,"i2c_errors":2,"reconnects":1,
+ *  "rss_kb":2140,"cpu_ms":5310,"queue_depth":2}
+ * @param buffer Output buffer (not NUL-terminated)
+ * @param size Buffer size (PAYLOAD_STATS_JSON_MAX is always enough)
+ * @param stats Snapshot to encode
+ * @return Number of bytes written, or -1 if the buffer is too small
+ */
+int payload_encode_stats_json(char* buffer, size_t size, const device_stats_t* stats);
+
+/**
+ * Encode consecutive readings as one binary payload (version 1)
+ * @param buffer Output buffer
+ * @param size Buffer size
+ * @param readings Readings to encode, oldest first, consecutive sequence numbers
+ * @param count Number of readings
+ * @return Number of bytes written, or -1 if the buffer is too small
+ */
+int payload_encode_binary(uint8_t* buffer, size_t size, const sensor_reading_t* readings, int count);
+
+/**
+ * Write a fixed-point hundredths value as a decimal ("-5.07", "23.40")
+ * @param buffer Output buffer, at least 13 bytes (not NUL-terminated)
+ * @param centi Value in hundredths
+ * @return Number of characters written
+ */
+size_t payload_format_centi(char* buffer, int32_t centi);
+
+/**
+ * Write an unsigned integer in decimal
+ * @param buffer Output buffer, at least 20 bytes (not NUL-terminated)
+ * @param value Value to write
+ * @return Number of characters written
+ */
+size_t payload_format_u64(char* buffer, uint64_t value);
+
+#endif // PAYLOAD_CODEC_H
@@ -0,0 +1,45 @@
+/**
+ * @file probes.h
+ * @brief USDT static tracepoints for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * SystemTap/USDT probes (provider "techtemp") at the start and end of the
+ * acquisition, publish and connection stages, for on-demand latency
+ * breakdowns with bpftrace or perf (see the .bt scripts in scripts/dev/).
+ *
+ * Built with TECHTEMP_USDT (set by the Makefile when <sys/sdt.h> is
+ * available), each probe is a single nop plus an ELF note: nothing runs
+ * until a tracer attaches. Without it, the probes compile to nothing.
+ * Arguments must stay cheap (integers and pointers already at hand).
+ *
+ * Probes and arguments:
+ *   i2c_start(address, tx_length, rx_length)   i2c_done(address, ok)
+ *   aht20_trigger(address)                     aht20_poll(address, status, busy_polls)
+ *   aht20_collect(address, status, result)
+ *   cycle_start(generation, lateness_us)       bus_cycle_start(i2c_bus, sensor_count)
+ *   bus_cycle_done(i2c_bus, sensor_count)
+ *   publish_start(topic, bytes)                publish_done(mid, bytes, result)
+ *   publish_ack(mid)
+ *   connect_start(host, port)                  connect_done(result)
+ *   connected(result)                          disconnected(result)
+ *   reconnect_scheduled(attempt, delay_ms)
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#ifdef TECHTEMP_USDT
+    #include <sys/sdt.h>
+    #define TECHTEMP_PROBE0(name)                   DTRACE_PROBE(techtemp, name)
+    #define TECHTEMP_PROBE1(name, a1)               DTRACE_PROBE1(techtemp, name, a1)
+    #define TECHTEMP_PROBE2(name, a1, a2)           DTRACE_PROBE2(techtemp, name, a1, a2)
+    #define TECHTEMP_PROBE3(name, a1, a2, a3)       DTRACE_PROBE3(techtemp, name, a1, a2, a3)
+#else
+    #define TECHTEMP_PROBE0(name)                   do { } while (0)
+    #define TECHTEMP_PROBE1(name, a1)               do { } while (0)
+    #define TECHTEMP_PROBE2(name, a1, a2)           do { } while (0)
+    #define TECHTEMP_PROBE3(name, a1, a2, a3)       do { } while (0)
+#endif
+
+#endif // PROBES_H
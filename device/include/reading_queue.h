@@ -0,0 +1,135 @@
+/**
+ * @file reading_queue.h
+ * @brief Persistent store-and-forward queue for sensor readings
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Crash-safe ring buffer of fixed-size records in an mmap'd file.
+ * Every reading is appended, published in order and only retired once
+ * the broker acknowledged it (PUBACK), so broker outages and restarts
+ * no longer lose history. Replays are idempotent on the backend side
+ * (readings_raw.msg_id unique index).
+ */
+
+#ifndef READING_QUEUE_H
+#define READING_QUEUE_H
+
+#include "common.h"
+
+// File layout constants
+#define READING_QUEUE_MAGIC         0x31515454u  // "TTQ1"
+#define READING_QUEUE_VERSION       2            // 2: fixed-point values in records
+#define READING_QUEUE_MAX_INFLIGHT  20           // Messages (libmosquitto default max_inflight_messages)
+#define READING_QUEUE_DEFAULT_CAPACITY 8640      // 3 days at 30 s
+
+struct queue_header;
+struct queue_record;
+
+// In-flight publish: one MQTT message covering `count` consecutive records
+typedef struct {
+    int mid;
+    uint32_t count;
+    bool acked;
+} reading_queue_inflight_t;
+
+// One queue (one per sensor); zero-initialize before reading_queue_open()
+typedef struct {
+    int fd;
+    uint8_t* mapping;
+    size_t mapping_size;
+    struct queue_header* header;
+    struct queue_record* records;
+    uint64_t send_seq;                     // Next record to publish
+    reading_queue_inflight_t inflight[READING_QUEUE_MAX_INFLIGHT];  // Ring, oldest first
+    int inflight_first;
+    int inflight_count;
+    int early_ack_mid;                     // QoS 0 ack delivered before mark_sent
+} reading_queue_t;
+
+/**
+ * Open (or create) the queue file and recover its content
+ * @param queue Queue to open
+ * @param path Queue file path (NULL or empty = memory only, not persistent)
+ * @param capacity Maximum number of stored readings
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int reading_queue_open(reading_queue_t* queue, const char* path, uint32_t capacity);
+
+/**
+ * Append a reading (overwrites the oldest one when the queue is full)
+ * @param queue Queue to append to
+ * @param reading Reading to store
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int reading_queue_push(reading_queue_t* queue, const sensor_reading_t* reading);
+
+/**
+ * Get the next readings waiting to be published, oldest first
+ * (consecutive sequence numbers, stored in each reading's seq field)
+ * @param queue Queue to read from
+ * @param readings Array to fill with queued readings
+ * @param max_count Maximum number of readings to return (1 = single publish)
+ * @return Number of readings copied, 0 if the queue is drained or the
+ *         in-flight window is full
+ */
+int reading_queue_peek_unsent(reading_queue_t* queue, sensor_reading_t* readings, int max_count);
+
+/**
+ * Record that readings returned by reading_queue_peek_unsent() were published
+ * @param queue Queue the readings came from
+ * @param mid MQTT message id returned by the publish call
+ * @param count Number of readings carried by this message
+ */
+void reading_queue_mark_sent(reading_queue_t* queue, int mid, int count);
+
+/**
+ * Retire the readings published with the given message id (PUBACK received)
+ * @param queue Queue to look the message up in
+ * @param mid MQTT message id from the publish callback
+ * @return true if the message belonged to this queue
+ */
+bool reading_queue_ack(reading_queue_t* queue, int mid);
+
+/**
+ * Record an acknowledgement delivered before reading_queue_mark_sent()
+ * (QoS 0 publish callback invoked from inside the publish call)
+ * @param queue Queue being published from
+ * @param mid MQTT message id from the publish callback
+ */
+void reading_queue_ack_unsent(reading_queue_t* queue, int mid);
+
+/**
+ * Forget in-flight state after a disconnection: unacknowledged readings
+ * will be published again, in order, after reconnection
+ * @param queue Queue to rewind
+ */
+void reading_queue_rewind(reading_queue_t* queue);
+
+/**
+ * Get the number of stored readings not yet acknowledged
+ * @param queue Queue to inspect
+ * @return Queue depth
+ */
+uint32_t reading_queue_depth(const reading_queue_t* queue);
+
+/**
+ * Get the number of stored readings not yet published
+ * @param queue Queue to inspect
+ * @return Number of unsent readings
+ */
+uint32_t reading_queue_unsent(const reading_queue_t* queue);
+
+/**
+ * Get the number of readings lost because the queue was full
+ * @param queue Queue to inspect
+ * @return Dropped readings counter (persistent)
+ */
+uint64_t reading_queue_dropped(const reading_queue_t* queue);
+
+/**
+ * Flush and close the queue file (no-op if it was never opened)
+ * @param queue Queue to close
+ */
+void reading_queue_close(reading_queue_t* queue);
+
+#endif // READING_QUEUE_H
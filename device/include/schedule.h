@@ -0,0 +1,57 @@
+/**
+ * @file schedule.h
+ * @brief Fleet-wide sampling schedule for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Aligns samples on wall-clock slots (multiples of the read interval)
+ * and spreads devices across the slot with a deterministic phase offset
+ * derived from device_uid, so a fleet restarted by a power cut does not
+ * publish in the same second. Deadlines are CLOCK_MONOTONIC milliseconds
+ * for absolute timerfds, recomputed from the wall clock at every slot.
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "common.h"
+
+/**
+ * Compute the per-device phase offset within the interval
+ * @param device_uid Device unique identifier (hashed with FNV-1a)
+ * @param interval_ms Read interval in milliseconds
+ * @return Offset in [0, interval_ms)
+ */
+uint32_t schedule_phase_offset_ms(const char* device_uid, uint32_t interval_ms);
+
+/**
+ * Compute the next slot deadline strictly after now
+ * @param interval_ms Read interval in milliseconds
+ * @param offset_ms Phase offset within the slot
+ * @return Monotonic deadline in milliseconds (for timer_fd_arm_abs_ms)
+ */
+uint64_t schedule_next_slot_ms(uint32_t interval_ms, uint32_t offset_ms);
+
+/**
+ * Compute the next free-running deadline: a fixed period from the previous
+ * one (no drift), whole periods skipped when it is already past
+ * @param previous_ms Previous monotonic deadline in milliseconds (0 = first, now + 1 ms)
+ * @param interval_ms Read interval in milliseconds
+ * @param skipped Receives the number of periods skipped (may be NULL)
+ * @return Monotonic deadline in milliseconds
+ */
+uint64_t schedule_next_period_ms(uint64_t previous_ms, uint32_t interval_ms, uint32_t* skipped);
+
+/**
+ * Get the monotonic clock in milliseconds
+ * @return CLOCK_MONOTONIC time in milliseconds
+ */
+uint64_t schedule_monotonic_ms(void);
+
+/**
+ * Get the monotonic clock in microseconds (latency measurements)
+ * @return CLOCK_MONOTONIC time in microseconds
+ */
+uint64_t schedule_monotonic_us(void);
+
+#endif // SCHEDULE_H
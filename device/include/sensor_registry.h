@@ -0,0 +1,92 @@
+/**
+ * @file sensor_registry.h
+ * @brief Sensor registry for TechTemp Device Client
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Owns every sensor of the device ([sensor.<id>] sections): its AHT20
+ * driver instance, its store-and-forward queue and its MQTT topics.
+ * Sensors behind a TCA9548A I2C multiplexer (several AHT20 share the
+ * fixed 0x38 address) are reached by opening their mux channel first;
+ * sensors are kept sorted by (bus, mux, channel, address) so each pass
+ * walking them in order (trigger, collect, retries, oversampling rounds)
+ * switches each mux channel at most once, keeping the switches per
+ * cycle to a minimum.
+ */
+
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include "common.h"
+#include "aht20.h"
+#include "reading_queue.h"
+#include "aggregate.h"
+
+// TCA9548A: one control byte, bit n enables channel n (0 = all channels off)
+#define TCA9548A_CHANNEL_COUNT  8
+
+// One registered sensor
+typedef struct {
+    char id[MAX_DEVICE_UID_LEN];   // Published as the device_uid of its readings
+    int i2c_bus;
+    uint8_t i2c_address;
+    uint8_t mux_address;           // 0 = wired directly on the bus
+    int mux_channel;
+    int mux_index;                 // Index in the registry mux table (-1 = direct)
+    aht20_t driver;
+    reading_queue_t queue;
+    char topic[MAX_TOPIC_LEN];
+    char batch_topic[MAX_TOPIC_LEN];
+    char aggregate_topic[MAX_TOPIC_LEN];
+    aggregate_window_t aggregates[MAX_AGGREGATE_WINDOWS];
+    int aggregate_count;
+    float temp_offset;             // Calibration offsets
+    float humidity_offset;
+    int32_t temp_offset_centi;     // Same offsets in hundredths (fixed-point path)
+    int32_t humidity_offset_centi;
+    bool available;                // Driver initialized (false: only its queue drains)
+    uint32_t retries;              // Measurements repeated after a rejected one
+    uint32_t failed_cycles;        // Cycles without a valid reading (each one resets the sensor)
+    bool has_published;            // Report by exception: last published values
+    int32_t published_temperature_centi;
+    int32_t published_humidity_centi;
+    uint64_t published_ms;         // Monotonic time of the last published reading
+    uint32_t suppressed;           // Readings inside the deadband (not published)
+} sensor_t;
+
+/**
+ * Create the sensors of the configuration: open the multiplexers,
+ * initialize the drivers and open the per-sensor queues
+ * A sensor that fails to initialize is kept, marked unavailable
+ * @param config Device configuration (sensors, topics, queue settings)
+ * @return TECHTEMP_OK if at least one sensor is available, error code otherwise
+ */
+int sensor_registry_init(const device_config_t* config);
+
+/**
+ * Get the number of registered sensors
+ * @return Sensor count
+ */
+int sensor_registry_count(void);
+
+/**
+ * Get a registered sensor, in (bus, mux, channel, address) order
+ * @param index Sensor index (0..sensor_registry_count() - 1)
+ * @return Sensor, or NULL if the index is out of range
+ */
+sensor_t* sensor_registry_get(int index);
+
+/**
+ * Route the I2C bus to a sensor (open its mux channel, close the others)
+ * Does nothing when the bus is already routed to it
+ * @param sensor Sensor about to be accessed
+ * @return TECHTEMP_OK on success, error code on failure
+ */
+int sensor_select(sensor_t* sensor);
+
+/**
+ * Close the drivers, queues and multiplexers
+ */
+void sensor_registry_cleanup(void);
+
+#endif // SENSOR_REGISTRY_H
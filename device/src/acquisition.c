@@ -0,0 +1,656 @@
+/**
+ * @file acquisition.c
+ * @brief Pipelined multi-sensor acquisition implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#define _GNU_SOURCE  // Pour pthread_sigmask(), pthread_setaffinity_np() et CPU_SET
+#include "acquisition.h"
+#include "sensor_registry.h"
+#include "schedule.h"
+#include "probes.h"
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/eventfd.h>
+
+// One reading handed from a bus worker to the event loop
+typedef struct {
+    int sensor_index;
+    sensor_reading_t reading;
+} acquisition_item_t;
+
+// Wait-free single-producer (bus worker) / single-consumer (event loop)
+// ring: each index is written by one side only, on its own cache line
+typedef struct {
+    acquisition_item_t slots[ACQUISITION_RING_SLOTS];
+    uint32_t head __attribute__((aligned(64)));  // Next slot written (producer)
+    uint32_t tail __attribute__((aligned(64)));  // Next slot read (consumer)
+    uint32_t dropped;                            // Ring full: readings lost
+} acquisition_ring_t;
+
+// Sensors of one bus (contiguous: the registry is sorted by bus first)
+typedef struct {
+    int i2c_bus;
+    int first;
+    int count;
+    pthread_t thread;
+    acquisition_ring_t ring;
+} bus_worker_t;
+
+// Result of one sensor
+typedef struct {
+    sensor_reading_t reading;
+    bool valid;
+} acquisition_result_t;
+
+// Oversampling window of one sensor: valid samples of the current cycle
+// (structure of arrays, reduced in place once the cycle ends)
+typedef struct {
+    int32_t temperature_centi[MAX_OVERSAMPLING];
+    int32_t humidity_centi[MAX_OVERSAMPLING];
+    int count;
+    uint64_t timestamp;                    // Last sample
+} sample_window_t;
+
+// Internal state
+static bus_worker_t workers[MAX_SENSORS];
+static int worker_count = 0;
+static acquisition_result_t results[MAX_SENSORS];
+static sample_window_t windows[MAX_SENSORS];
+static int oversampling = 1;
+static oversampling_filter_t oversampling_filter = OVERSAMPLING_MEDIAN;
+static pthread_mutex_t cycle_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cycle_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t cycle_generation = 0;      // Incremented for each cycle
+static int pending_workers = 0;            // Workers still running the cycle (atomic)
+static bool stopping = false;
+static uint64_t cycle_start_ms = 0;
+static uint64_t cycle_deadline_us = 0;     // Intended start of the cycle
+static uint64_t round_spacing_us = 0;      // Oversampling: between the starts of two rounds
+static int done_fd = -1;
+static metric_t* jitter_metric = NULL;
+static metric_t* skipped_metric = NULL;
+static metric_t* ring_dropped_metric = NULL;
+
+// Real-time mode: pacer thread and scheduling of the acquisition threads
+static bool realtime = false;
+static int realtime_cpu = -1;
+static int realtime_priority = 0;
+static bool pacer_started = false;
+static pthread_t pacer_thread;
+static uint32_t pacer_interval_ms = 0;
+static uint32_t pacer_offset_ms = 0;
+static bool pacer_aligned = false;        // Wall-clock slots (spread) instead of a free period
+
+// Internal helper functions
+static void* worker_main(void* arg);
+static void* pacer_main(void* arg);
+static uint64_t pacer_next_deadline(uint64_t deadline_ms);
+static void apply_realtime(pthread_t thread, int priority, const char* name);
+static void run_bus_cycle(bus_worker_t* worker, uint64_t deadline_us);
+static bool wait_until(uint64_t deadline_us);
+static uint64_t lateness_since(uint64_t intended_us);
+static void run_bus_round(const bus_worker_t* worker, uint64_t intended_us);
+static void window_reduce(sample_window_t* window, sensor_reading_t* reading);
+static int32_t reduce_samples(int32_t* samples, int count);
+static void ring_push(acquisition_ring_t* ring, int sensor_index, const sensor_reading_t* reading);
+static bool ring_pop(acquisition_ring_t* ring, acquisition_item_t* item);
+static int wait_ready(sensor_t* sensor);
+static int measure_one(sensor_t* sensor, sensor_reading_t* reading);
+static void retry_or_reset(sensor_t* sensor, acquisition_result_t* result);
+
+/**
+ * Start one worker thread per I2C bus
+ */
+int acquisition_init(const device_config_t* config) {
+    oversampling = config->oversampling;
+    oversampling_filter = config->oversampling_filter;
+    round_spacing_us = (uint64_t)config->read_interval * 1000000ULL / (2 * (uint64_t)config->oversampling);
+    realtime = config->realtime;
+    realtime_cpu = config->realtime_cpu;
+    realtime_priority = config->realtime_priority;
+    pacer_interval_ms = (uint32_t)config->read_interval * 1000;
+    pacer_aligned = (config->schedule_mode == SCHEDULE_SPREAD);
+    pacer_offset_ms = pacer_aligned ? schedule_phase_offset_ms(config->device_uid, pacer_interval_ms) : 0;
+    
+    jitter_metric = metric_register("techtemp_sample_jitter_us",
+                                    "Delay between the intended sample time and the first trigger on a bus",
+                                    METRIC_HISTOGRAM);
+    skipped_metric = metric_register("techtemp_samples_skipped_total",
+                                     "Samples skipped because the previous cycle was still running",
+                                     METRIC_COUNTER);
+    ring_dropped_metric = metric_register("techtemp_acquisition_dropped_total",
+                                          "Readings lost because an acquisition ring was full", METRIC_COUNTER);
+    
+    done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (done_fd < 0) {
+        LOG_ERROR_F("Failed to create acquisition eventfd: %s", strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    // Oversampling rounds wait on the cycle condition (stop wakes them) against CLOCK_MONOTONIC
+    pthread_condattr_t condition_attributes;
+    pthread_condattr_init(&condition_attributes);
+    pthread_condattr_setclock(&condition_attributes, CLOCK_MONOTONIC);
+    pthread_cond_destroy(&cycle_cond);
+    pthread_cond_init(&cycle_cond, &condition_attributes);
+    pthread_condattr_destroy(&condition_attributes);
+    
+    stopping = false;
+    cycle_generation = 0;
+    pending_workers = 0;
+    worker_count = 0;
+    for (int i = 0; i < sensor_registry_count(); i++) {
+        sensor_t* sensor = sensor_registry_get(i);
+        if (worker_count == 0 || workers[worker_count - 1].i2c_bus != sensor->i2c_bus) {
+            workers[worker_count].i2c_bus = sensor->i2c_bus;
+            workers[worker_count].first = i;
+            workers[worker_count].count = 0;
+            memset(&workers[worker_count].ring, 0, sizeof(workers[worker_count].ring));
+            worker_count++;
+        }
+        workers[worker_count - 1].count++;
+    }
+    
+    // Real-time: small stacks, mlockall() commits them entirely
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    if (realtime) {
+        pthread_attr_setstacksize(&attributes, ACQUISITION_RT_STACK_SIZE);
+    }
+    
+    // Workers must never receive process signals (they go to the signalfd)
+    sigset_t all_signals, previous;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &previous);
+    int started = 0;
+    int result = 0;
+    for (; started < worker_count; started++) {
+        result = pthread_create(&workers[started].thread, &attributes, worker_main, &workers[started]);
+        if (result != 0) {
+            break;
+        }
+    }
+    if (started == worker_count && realtime) {
+        result = pthread_create(&pacer_thread, &attributes, pacer_main, NULL);
+        pacer_started = (result == 0);
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    pthread_attr_destroy(&attributes);
+    
+    if (started < worker_count) {
+        LOG_ERROR_F("Failed to start acquisition thread for bus %d: %s",
+                    workers[started].i2c_bus, strerror(result));
+        worker_count = started;
+        acquisition_cleanup();
+        return TECHTEMP_ERROR;
+    }
+    if (realtime && !pacer_started) {
+        LOG_ERROR_F("Failed to start the real-time pacer thread: %s", strerror(result));
+        acquisition_cleanup();
+        return TECHTEMP_ERROR;
+    }
+    
+    // The pacer preempts the workers: its wakeup is the sample time
+    if (realtime) {
+        int worker_priority = realtime_priority > 1 ? realtime_priority - 1 : 1;
+        for (int i = 0; i < worker_count; i++) {
+            apply_realtime(workers[i].thread, worker_priority, "acquisition worker");
+        }
+        apply_realtime(pacer_thread, realtime_priority, "pacer");
+        LOG_INFO_F("Real-time sampling: SCHED_FIFO priority %d, CPU %d, %s deadlines every %u ms",
+                   realtime_priority, realtime_cpu, pacer_aligned ? "slot" : "free-running", pacer_interval_ms);
+    }
+    
+    LOG_INFO_F("Acquisition: %d sensor(s) on %d bus(es)", sensor_registry_count(), worker_count);
+    if (oversampling > 1) {
+        LOG_INFO_F("Oversampling: %d samples per reading (%s)", oversampling,
+                   oversampling_filter == OVERSAMPLING_MEDIAN ? "median" : "trimmed mean");
+    }
+    return TECHTEMP_OK;
+}
+
+/**
+ * Get the completion file descriptor
+ */
+int acquisition_get_fd(void) {
+    return done_fd;
+}
+
+/**
+ * Start a cycle over all available sensors
+ */
+int acquisition_start_cycle(uint64_t deadline_us) {
+    if (worker_count == 0) {
+        return TECHTEMP_ERROR;
+    }
+    
+    if (acquisition_busy()) {
+        metric_inc(skipped_metric);
+        return TECHTEMP_ERROR;
+    }
+    
+    // Start signal only: the readings come back through the rings
+    pthread_mutex_lock(&cycle_mutex);
+    cycle_start_ms = schedule_monotonic_ms();
+    cycle_deadline_us = deadline_us;
+    cycle_generation++;
+    // Dispatch lateness (trace only): the sample jitter is measured by the workers
+    TECHTEMP_PROBE2(cycle_start, cycle_generation, lateness_since(deadline_us));
+    __atomic_store_n(&pending_workers, worker_count, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&cycle_cond);
+    pthread_mutex_unlock(&cycle_mutex);
+    return TECHTEMP_OK;
+}
+
+/**
+ * Check whether a cycle is running
+ */
+bool acquisition_busy(void) {
+    return __atomic_load_n(&pending_workers, __ATOMIC_ACQUIRE) > 0;
+}
+
+/**
+ * Hand the readings waiting in the rings to the event loop
+ */
+int acquisition_drain(acquisition_reading_cb_t callback) {
+    uint64_t value;
+    if (read(done_fd, &value, sizeof(value)) != sizeof(value) && errno != EAGAIN) {
+        LOG_WARN_F("Failed to read acquisition eventfd: %s", strerror(errno));
+    }
+    
+    int count = 0;
+    acquisition_item_t item;
+    for (int i = 0; i < worker_count; i++) {
+        while (ring_pop(&workers[i].ring, &item)) {
+            callback(item.sensor_index, &item.reading);
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Stop the worker threads
+ */
+void acquisition_cleanup(void) {
+    // Pacer first: no cycle starts once the workers are told to stop
+    if (pacer_started) {
+        pthread_cancel(pacer_thread);
+        pthread_join(pacer_thread, NULL);
+        pacer_started = false;
+    }
+    
+    pthread_mutex_lock(&cycle_mutex);
+    stopping = true;
+    pthread_cond_broadcast(&cycle_cond);
+    pthread_mutex_unlock(&cycle_mutex);
+    
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].ring.dropped > 0) {
+            LOG_WARN_F("⚠️  Bus %d: %u readings dropped (acquisition ring full)",
+                       workers[i].i2c_bus, workers[i].ring.dropped);
+        }
+    }
+    worker_count = 0;
+    pending_workers = 0;
+    
+    if (done_fd >= 0) {
+        close(done_fd);
+        done_fd = -1;
+    }
+}
+
+// Internal helper functions
+
+static void* worker_main(void* arg) {
+    bus_worker_t* worker = arg;
+    uint32_t handled = 0;  // Generation 0: a cycle started before this thread ran is not missed
+    
+    pthread_mutex_lock(&cycle_mutex);
+    for (;;) {
+        while (!stopping && cycle_generation == handled) {
+            pthread_cond_wait(&cycle_cond, &cycle_mutex);
+        }
+        if (stopping) {
+            break;
+        }
+        handled = cycle_generation;
+        uint64_t start_ms = cycle_start_ms;  // Rewritten by the next cycle once pending_workers is 0
+        uint64_t deadline_us = cycle_deadline_us;
+        pthread_mutex_unlock(&cycle_mutex);
+        
+        TECHTEMP_PROBE2(bus_cycle_start, worker->i2c_bus, worker->count);
+        run_bus_cycle(worker, deadline_us);
+        TECHTEMP_PROBE2(bus_cycle_done, worker->i2c_bus, worker->count);
+        
+        // Readings of this bus are in its ring: wake the event loop now,
+        // without waiting for the other buses
+        uint64_t one = 1;
+        if (write(done_fd, &one, sizeof(one)) != sizeof(one)) {
+            LOG_ERROR_F("Failed to signal acquisition completion: %s", strerror(errno));
+        }
+        if (__atomic_sub_fetch(&pending_workers, 1, __ATOMIC_ACQ_REL) == 0) {
+            LOG_DEBUG_F("Acquisition cycle: %d sensor(s) on %d bus(es) in %llu ms", sensor_registry_count(),
+                        worker_count, (unsigned long long)(schedule_monotonic_ms() - start_ms));
+        }
+        
+        pthread_mutex_lock(&cycle_mutex);
+    }
+    pthread_mutex_unlock(&cycle_mutex);
+    return NULL;
+}
+
+static void* pacer_main(void* arg) {
+    (void)arg;
+    
+    // Cancelled by acquisition_cleanup(), only while sleeping
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    
+    uint64_t deadline_ms = pacer_aligned ? schedule_next_slot_ms(pacer_interval_ms, pacer_offset_ms)
+                                         : schedule_next_period_ms(0, pacer_interval_ms, NULL);
+    for (;;) {
+        // Absolute deadline: the time spent starting a cycle never accumulates
+        struct timespec deadline = {
+            .tv_sec = (time_t)(deadline_ms / 1000),
+            .tv_nsec = (long)(deadline_ms % 1000) * 1000000L
+        };
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        int result = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+        if (result == EINTR) {
+            continue;
+        }
+        if (result != 0) {
+            LOG_ERROR_F("Real-time pacer stopped: clock_nanosleep failed: %s", strerror(result));
+            break;
+        }
+        
+        if (acquisition_start_cycle(deadline_ms * 1000) != TECHTEMP_OK) {
+            LOG_WARN_F("⚠️  Previous measurement still in progress, skipping sample");
+        }
+        deadline_ms = pacer_next_deadline(deadline_ms);
+    }
+    return NULL;
+}
+
+static uint64_t pacer_next_deadline(uint64_t deadline_ms) {
+    if (pacer_aligned) {
+        // Recomputed from the wall clock, never twice in the same slot
+        uint64_t next_ms = schedule_next_slot_ms(pacer_interval_ms, pacer_offset_ms);
+        if (next_ms < deadline_ms + pacer_interval_ms / 2) {
+            next_ms += pacer_interval_ms;
+        }
+        return next_ms;
+    }
+    
+    uint32_t skipped = 0;
+    deadline_ms = schedule_next_period_ms(deadline_ms, pacer_interval_ms, &skipped);
+    metric_add(skipped_metric, skipped);
+    return deadline_ms;
+}
+
+static void apply_realtime(pthread_t thread, int priority, const char* name) {
+    // Best effort: without CAP_SYS_NICE the thread keeps SCHED_OTHER
+    struct sched_param parameters = { .sched_priority = priority };
+    int result = pthread_setschedparam(thread, SCHED_FIFO, &parameters);
+    if (result != 0) {
+        LOG_WARN_F("⚠️  Cannot give the %s thread SCHED_FIFO priority %d: %s", name, priority, strerror(result));
+    }
+    
+    if (realtime_cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(realtime_cpu, &cpus);
+        result = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+        if (result != 0) {
+            LOG_WARN_F("⚠️  Cannot pin the %s thread to CPU %d: %s", name, realtime_cpu, strerror(result));
+        }
+    }
+}
+
+static void run_bus_cycle(bus_worker_t* worker, uint64_t deadline_us) {
+    for (int i = worker->first; i < worker->first + worker->count; i++) {
+        windows[i].count = 0;
+    }
+    
+    // Oversampling: rounds spaced over half the interval, each one pipelined over the bus
+    for (int round = 0; round < oversampling; round++) {
+        if (round > 0 && !wait_until(deadline_us + (uint64_t)round * round_spacing_us)) {
+            break;  // Stopping: reduce the samples already taken
+        }
+        run_bus_round(worker, deadline_us + (uint64_t)round * round_spacing_us);
+        for (int i = worker->first; i < worker->first + worker->count; i++) {
+            sample_window_t* window = &windows[i];
+            if (results[i].valid) {
+                window->temperature_centi[window->count] = results[i].reading.temperature_centi;
+                window->humidity_centi[window->count] = results[i].reading.humidity_centi;
+                window->timestamp = results[i].reading.timestamp;
+                window->count++;
+            }
+        }
+    }
+    
+    for (int i = worker->first; i < worker->first + worker->count; i++) {
+        sensor_t* sensor = sensor_registry_get(i);
+        if (!sensor->available) {
+            continue;
+        }
+        
+        if (windows[i].count == 0) {
+            // Rejected sensors: measured again one by one, within the retry budget
+            retry_or_reset(sensor, &results[i]);
+        } else if (oversampling > 1) {
+            LOG_DEBUG_F("Sensor %s: %d of %d samples kept", sensor->id, windows[i].count, oversampling);
+            window_reduce(&windows[i], &results[i].reading);
+            results[i].valid = true;
+        }
+        
+        if (results[i].valid) {
+            ring_push(&worker->ring, i, &results[i].reading);
+        }
+    }
+}
+
+static bool wait_until(uint64_t deadline_us) {
+    // Absolute deadline: a late round never delays the following ones
+    struct timespec deadline = {
+        .tv_sec = (time_t)(deadline_us / 1000000),
+        .tv_nsec = (long)(deadline_us % 1000000) * 1000L
+    };
+    
+    pthread_mutex_lock(&cycle_mutex);
+    while (!stopping && schedule_monotonic_us() < deadline_us) {
+        pthread_cond_timedwait(&cycle_cond, &cycle_mutex, &deadline);
+    }
+    bool running = !stopping;
+    pthread_mutex_unlock(&cycle_mutex);
+    return running;
+}
+
+static uint64_t lateness_since(uint64_t intended_us) {
+    uint64_t now_us = schedule_monotonic_us();
+    return now_us > intended_us ? now_us - intended_us : 0;
+}
+
+static void run_bus_round(const bus_worker_t* worker, uint64_t intended_us) {
+    bool triggered[MAX_SENSORS] = {false};
+    bool sampled = false;
+    
+    // Trigger every sensor of the bus: conversions overlap
+    for (int i = worker->first; i < worker->first + worker->count; i++) {
+        sensor_t* sensor = sensor_registry_get(i);
+        results[i].valid = false;
+        if (!sensor->available) {
+            continue;
+        }
+        
+        if (sensor_select(sensor) != TECHTEMP_OK) {
+            LOG_WARN_F("⚠️  Failed to select sensor %s", sensor->id);
+            continue;
+        }
+        
+        // Actual sample time of the bus: after the handoff, the wakeup and the mux select
+        if (!sampled) {
+            metric_observe(jitter_metric, lateness_since(intended_us));
+            sampled = true;
+        }
+        
+        LOG_DEBUG_F("Triggering measurement on %s...", sensor->id);
+        if (aht20_trigger(&sensor->driver) != TECHTEMP_OK) {
+            LOG_WARN_F("⚠️  Failed to read sensor %s: %s", sensor->id, aht20_get_error(&sensor->driver));
+            continue;
+        }
+        triggered[i] = true;
+    }
+    
+    // Collect in trigger order: only the first wait covers the conversion
+    // window, the later deadlines have expired by then
+    for (int i = worker->first; i < worker->first + worker->count; i++) {
+        if (!triggered[i]) {
+            continue;
+        }
+        
+        sensor_t* sensor = sensor_registry_get(i);
+        if (sensor_select(sensor) != TECHTEMP_OK) {
+            LOG_WARN_F("⚠️  Failed to select sensor %s", sensor->id);
+            aht20_cancel(&sensor->driver);
+            continue;
+        }
+        
+        if (wait_ready(sensor) != TECHTEMP_OK ||
+            aht20_collect(&sensor->driver, &results[i].reading) != TECHTEMP_OK) {
+            LOG_WARN_F("⚠️  Failed to read sensor %s: %s", sensor->id, aht20_get_error(&sensor->driver));
+            continue;
+        }
+        results[i].valid = results[i].reading.valid;
+    }
+}
+
+static void window_reduce(sample_window_t* window, sensor_reading_t* reading) {
+    reading->temperature_centi = reduce_samples(window->temperature_centi, window->count);
+    reading->humidity_centi = reduce_samples(window->humidity_centi, window->count);
+    reading->temperature = (float)reading->temperature_centi / 100.0f;
+    reading->humidity = (float)reading->humidity_centi / 100.0f;
+    reading->timestamp = window->timestamp;
+    reading->valid = true;
+}
+
+static int32_t reduce_samples(int32_t* samples, int count) {
+    // Insertion sort: at most MAX_OVERSAMPLING values, already in cache
+    for (int i = 1; i < count; i++) {
+        int32_t value = samples[i];
+        int j = i;
+        for (; j > 0 && samples[j - 1] > value; j--) {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = value;
+    }
+    
+    // Median: middle value, or mean of the two middle values
+    int first = count / 2 - (count % 2 == 0 ? 1 : 0);
+    int last = count / 2;
+    if (oversampling_filter == OVERSAMPLING_TRIMMED_MEAN) {
+        // Lowest and highest quarter, at least one sample each once there are 3
+        int trim = count / 4;
+        if (trim == 0 && count >= 3) {
+            trim = 1;
+        }
+        first = trim;
+        last = count - 1 - trim;
+    }
+    
+    int64_t sum = 0;
+    for (int i = first; i <= last; i++) {
+        sum += samples[i];
+    }
+    int64_t kept = last - first + 1;
+    
+    // Rounded to the nearest hundredth, halves away from zero
+    return (int32_t)((sum >= 0 ? sum + kept / 2 : sum - kept / 2) / kept);
+}
+
+static int wait_ready(sensor_t* sensor) {
+    bool ready = false;
+    while (!ready) {
+        struct pollfd pfd = { .fd = aht20_get_timer_fd(&sensor->driver), .events = POLLIN };
+        if (poll(&pfd, 1, AHT20_MEASURE_DELAY_MS) < 0 && errno != EINTR) {
+            aht20_cancel(&sensor->driver);
+            LOG_WARN_F("⚠️  Failed to wait for the conversion of %s: %s", sensor->id, strerror(errno));
+            return TECHTEMP_ERROR;
+        }
+        
+        int result = aht20_poll_ready(&sensor->driver, &ready);
+        if (result != TECHTEMP_OK) {
+            return result;
+        }
+    }
+    return TECHTEMP_OK;
+}
+
+static int measure_one(sensor_t* sensor, sensor_reading_t* reading) {
+    if (sensor_select(sensor) != TECHTEMP_OK) {
+        return TECHTEMP_ERROR;
+    }
+    
+    int result = aht20_trigger(&sensor->driver);
+    if (result == TECHTEMP_OK) {
+        result = wait_ready(sensor);
+    }
+    if (result == TECHTEMP_OK) {
+        result = aht20_collect(&sensor->driver, reading);
+    }
+    if (result != TECHTEMP_OK) {
+        LOG_WARN_F("⚠️  Failed to read sensor %s: %s", sensor->id, aht20_get_error(&sensor->driver));
+    }
+    return result;
+}
+
+static void retry_or_reset(sensor_t* sensor, acquisition_result_t* result) {
+    for (int attempt = 1; attempt <= ACQUISITION_RETRY_BUDGET && !result->valid; attempt++) {
+        sensor->retries++;
+        LOG_DEBUG_F("Retrying sensor %s (%d/%d)", sensor->id, attempt, ACQUISITION_RETRY_BUDGET);
+        result->valid = (measure_one(sensor, &result->reading) == TECHTEMP_OK && result->reading.valid);
+    }
+    if (result->valid) {
+        return;
+    }
+    
+    // Budget exhausted: soft reset and re-initialization, sample skipped
+    sensor->failed_cycles++;
+    LOG_WARN_F("⚠️  Sensor %s: no valid reading after %d retries, resetting it",
+               sensor->id, ACQUISITION_RETRY_BUDGET);
+    if (sensor_select(sensor) != TECHTEMP_OK || aht20_reset(&sensor->driver) != TECHTEMP_OK) {
+        LOG_WARN_F("⚠️  Failed to reset sensor %s: %s", sensor->id, aht20_get_error(&sensor->driver));
+    }
+}
+
+static void ring_push(acquisition_ring_t* ring, int sensor_index, const sensor_reading_t* reading) {
+    uint32_t head = ring->head;  // Written by this thread only
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == ACQUISITION_RING_SLOTS) {
+        // Event loop stalled for several cycles: never block the sampling
+        ring->dropped++;
+        metric_inc(ring_dropped_metric);
+        return;
+    }
+    
+    acquisition_item_t* slot = &ring->slots[head % ACQUISITION_RING_SLOTS];
+    slot->sensor_index = sensor_index;
+    slot->reading = *reading;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static bool ring_pop(acquisition_ring_t* ring, acquisition_item_t* item) {
+    uint32_t tail = ring->tail;  // Written by this thread only
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+    
+    *item = ring->slots[tail % ACQUISITION_RING_SLOTS];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file aggregate.c
+ * @brief Windowed on-device aggregation implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#include "aggregate.h"
+
+// Internal helper functions
+static void stat_start(aggregate_metric_t* metric, int32_t value);
+static void stat_add(aggregate_metric_t* metric, int32_t value);
+static void retire_acked(aggregate_window_t* window);
+
+/**
+ * Initialize an aggregation window
+ */
+void aggregate_init(aggregate_window_t* window, uint32_t window_s) {
+    memset(window, 0, sizeof(*window));
+    window->window_s = window_s;
+    window->current.window_s = window_s;
+    window->early_ack_mid = -1;
+}
+
+/**
+ * Add a reading to its bucket
+ */
+bool aggregate_add(aggregate_window_t* window, const sensor_reading_t* reading) {
+    uint64_t window_ms = (uint64_t)window->window_s * 1000;
+    uint64_t start_ms = reading->timestamp - reading->timestamp % window_ms;
+    aggregate_bucket_t* current = &window->current;
+    
+    if (current->count > 0 && current->start_ms == start_ms) {
+        current->count++;
+        stat_add(&current->temperature, reading->temperature_centi);
+        stat_add(&current->humidity, reading->humidity_centi);
+        return false;
+    }
+    
+    // Another bucket (next one, or the clock stepped): close the current one
+    bool closed = false;
+    if (current->count > 0) {
+        if (window->pending_count == AGGREGATE_PENDING_MAX) {
+            // Full while MQTT is down: the oldest bucket is lost
+            window->pending_first = (window->pending_first + 1) % AGGREGATE_PENDING_MAX;
+            window->pending_count--;
+            if (window->pending_sent > 0) {
+                window->pending_sent--;  // Its PUBACK, if any, is ignored
+            }
+            window->dropped++;
+        }
+        int slot = (window->pending_first + window->pending_count) % AGGREGATE_PENDING_MAX;
+        window->pending[slot] = *current;
+        window->pending_acked[slot] = false;
+        window->pending_count++;
+        closed = true;
+    }
+    
+    current->start_ms = start_ms;
+    current->count = 1;
+    stat_start(&current->temperature, reading->temperature_centi);
+    stat_start(&current->humidity, reading->humidity_centi);
+    return closed;
+}
+
+/**
+ * Get the oldest closed bucket not published yet
+ */
+const aggregate_bucket_t* aggregate_peek_unsent(const aggregate_window_t* window) {
+    if (window->pending_sent == window->pending_count) {
+        return NULL;
+    }
+    return &window->pending[(window->pending_first + window->pending_sent) % AGGREGATE_PENDING_MAX];
+}
+
+/**
+ * Record the message id of the bucket just published
+ */
+void aggregate_mark_sent(aggregate_window_t* window, int mid) {
+    if (window->pending_sent == window->pending_count) {
+        return;
+    }
+    
+    int slot = (window->pending_first + window->pending_sent) % AGGREGATE_PENDING_MAX;
+    window->pending_mid[slot] = mid;
+    window->pending_acked[slot] = (mid == window->early_ack_mid);
+    window->early_ack_mid = -1;
+    window->pending_sent++;
+    
+    retire_acked(window);
+}
+
+/**
+ * Retire the bucket acknowledged by the broker
+ */
+bool aggregate_ack(aggregate_window_t* window, int mid) {
+    for (int i = 0; i < window->pending_sent; i++) {
+        int slot = (window->pending_first + i) % AGGREGATE_PENDING_MAX;
+        if (window->pending_mid[slot] == mid) {
+            window->pending_acked[slot] = true;
+            retire_acked(window);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Remember an acknowledgement delivered inside the publish call
+ */
+void aggregate_ack_unsent(aggregate_window_t* window, int mid) {
+    window->early_ack_mid = mid;
+}
+
+/**
+ * Forget in-flight state after a disconnection
+ */
+void aggregate_rewind(aggregate_window_t* window) {
+    window->pending_sent = 0;
+    window->early_ack_mid = -1;
+}
+
+// Internal helper functions
+
+static void stat_start(aggregate_metric_t* metric, int32_t value) {
+    metric->min = value;
+    metric->max = value;
+    metric->sum = value;
+}
+
+static void stat_add(aggregate_metric_t* metric, int32_t value) {
+    if (value < metric->min) {
+        metric->min = value;
+    }
+    if (value > metric->max) {
+        metric->max = value;
+    }
+    metric->sum += value;
+}
+
+static void retire_acked(aggregate_window_t* window) {
+    // In order: a bucket acknowledged early waits for the older ones
+    while (window->pending_sent > 0 && window->pending_acked[window->pending_first]) {
+        window->pending_first = (window->pending_first + 1) % AGGREGATE_PENDING_MAX;
+        window->pending_count--;
+        window->pending_sent--;
+    }
+}
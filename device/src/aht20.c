@@ -9,29 +9,13 @@
 
 #define _DEFAULT_SOURCE  // Pour usleep()
 #include "aht20.h"
+#include "schedule.h"
+#include "probes.h"
 #include <stdarg.h>
 #include <unistd.h>
 #include <string.h>
-#ifdef SIMULATION_MODE
-    // Simulation stubs
-    #define wiringPiSetup() 0
-    #define wiringPiI2CSetup(addr) 42
-    #define wiringPiI2CWrite(fd, data) 0
-    #define wiringPiI2CRead(fd) 0x18
-    #define usleep(us) 
-    #define write(fd, buf, count) count
-    #define read(fd, buf, count) count
-#else
-    #include <sys/ioctl.h>
-    #include <fcntl.h>
-    #include <errno.h>
-    #ifdef __linux__
-        #include <linux/i2c-dev.h>
-    #else
-        // Headers pour environnement de dev non-Linux
-        #define I2C_SLAVE 0x0703
-    #endif
-#endif
+#include <poll.h>
+#include <sys/timerfd.h>
 
 // AHT20 Constants (basé sur la référence Adafruit)
 #define AHT20_CMD_SOFTRESET     0xBA
@@ -44,28 +28,34 @@
 #define AHT20_POWERUP_DELAY_MS  20
 #define AHT20_BUSY_TIMEOUT      10
 
-// Internal state
-static int i2c_handle = -1;
-static bool initialized = false;
-static char last_error[256] = "";
+// Shared by all sensors (registered by the first aht20_init)
+static metric_t* i2c_duration_metric = NULL;
+static metric_t* busy_poll_metric = NULL;
+static metric_t* error_metric = NULL;
+
+// Transport of the sensors initialized next (simulation builds select the emulator)
+static const i2c_transport_t* current_transport = &i2c_dev_transport;
 
 // Internal helper functions
 static void aht20_delay_ms(int ms);
-static float calculate_temperature(uint32_t raw_temp);
-static float calculate_humidity(uint32_t raw_humidity);
-static void set_error(const char* format, ...);
-static bool write_i2c_block(uint8_t* data, int length);
-static bool read_i2c_block(uint8_t* buffer, int length);
-static uint8_t aht20_get_status(void);
-static bool aht20_wait_not_busy(int timeout_cycles);
+static inline void unpack_frame(const uint8_t* data, uint32_t* raw_humidity, uint32_t* raw_temperature);
+static inline void convert_frames(const uint8_t* frames, size_t frame_length, size_t count,
+                                  int32_t* restrict temperature_centi, int32_t* restrict humidity_centi);
+static void set_error(aht20_t* sensor, const char* format, ...);
+static bool i2c_transfer(aht20_t* sensor, uint8_t* tx, int tx_length, uint8_t* rx, int rx_length);
+static uint8_t aht20_get_status(aht20_t* sensor);
+static bool aht20_wait_not_busy(aht20_t* sensor, int timeout_cycles);
+static int arm_timer(aht20_t* sensor, int delay_ms);
+static bool timer_expired(aht20_t* sensor);
+static int reset_and_calibrate(aht20_t* sensor);
 
 /**
  * Set error message
  */
-static void set_error(const char* format, ...) {
+static void set_error(aht20_t* sensor, const char* format, ...) {
     va_list args;
     va_start(args, format);
-    vsnprintf(last_error, sizeof(last_error), format, args);
+    vsnprintf(sensor->last_error, sizeof(sensor->last_error), format, args);
     va_end(args);
 }
 
@@ -77,42 +67,44 @@ static void aht20_delay_ms(int ms) {
 }
 
 /**
- * Write multiple bytes in a single I2C transaction
- */
-static bool write_i2c_block(uint8_t* data, int length) {
-    ssize_t result = write(i2c_handle, data, length);
-    return (result == length);
-}
-
-/**
- * Read multiple bytes in a single I2C transaction
+ * One I2C transaction through the transport: optional write, then optional
+ * read after a repeated start (I2C_RDWR: a single ioctl, a single START...STOP)
  */
-static bool read_i2c_block(uint8_t* buffer, int length) {
-    ssize_t result = read(i2c_handle, buffer, length);
-    return (result == length);
+static bool i2c_transfer(aht20_t* sensor, uint8_t* tx, int tx_length, uint8_t* rx, int rx_length) {
+    sensor->io_syscalls++;
+    sensor->io_transactions++;
+    
+    TECHTEMP_PROBE3(i2c_start, sensor->address, tx_length, rx_length);
+    uint64_t start_us = schedule_monotonic_us();
+    int result = sensor->transport->transfer(sensor->i2c_handle, sensor->address, tx, tx_length, rx, rx_length);
+    metric_observe(i2c_duration_metric, schedule_monotonic_us() - start_us);
+    TECHTEMP_PROBE2(i2c_done, sensor->address, result == 0);
+    if (result != 0) {
+        sensor->stats.io_errors++;
+        metric_inc(error_metric);
+        return false;
+    }
+    return true;
 }
 
 /**
- * Get sensor status
+ * Get sensor status (status command and status byte in one transaction)
  */
-static uint8_t aht20_get_status(void) {
-#ifdef SIMULATION_MODE
-    return 0x18;  // Simulated status
-#else
+static uint8_t aht20_get_status(aht20_t* sensor) {
+    uint8_t command = AHT20_CMD_STATUS;
     uint8_t status;
-    if (read(i2c_handle, &status, 1) != 1) {
+    if (!i2c_transfer(sensor, &command, 1, &status, 1)) {
         return 0xFF;
     }
     return status;
-#endif
 }
 
 /**
  * Wait for sensor to not be busy
  */
-static bool aht20_wait_not_busy(int timeout_cycles) {
+static bool aht20_wait_not_busy(aht20_t* sensor, int timeout_cycles) {
     while (timeout_cycles-- > 0) {
-        uint8_t status = aht20_get_status();
+        uint8_t status = aht20_get_status(sensor);
         if (status == 0xFF) {
             return false;
         }
@@ -125,176 +117,476 @@ static bool aht20_wait_not_busy(int timeout_cycles) {
 }
 
 /**
- * Calculate temperature from raw value (based on Adafruit formula)
+ * Arm the conversion timer for a one-shot deadline
  */
-static float calculate_temperature(uint32_t raw_temp) {
-    return ((float)raw_temp * 200.0 / 0x100000) - 50.0;
+static int arm_timer(aht20_t* sensor, int delay_ms) {
+    struct itimerspec spec = {
+        .it_interval = {0, 0},
+        .it_value = {delay_ms / 1000, (long)(delay_ms % 1000) * 1000000L}
+    };
+    return timerfd_settime(sensor->timer_fd, 0, &spec, NULL);
 }
 
 /**
- * Calculate humidity from raw value (based on Adafruit formula)
+ * Consume the conversion timer (non-blocking)
  */
-static float calculate_humidity(uint32_t raw_humidity) {
-    return ((float)raw_humidity * 100.0) / 0x100000;
+static bool timer_expired(aht20_t* sensor) {
+    uint64_t expirations;
+    return read(sensor->timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations);
 }
 
 /**
- * Initialize AHT20 sensor
+ * Extract the 20-bit humidity and temperature counts of a frame (status first)
  */
-int aht20_init(int i2c_bus, uint8_t address) {
-    LOG_DEBUG_F("Initializing AHT20 on I2C bus %d, address 0x%02X", i2c_bus, address);
-    
-#ifdef SIMULATION_MODE
-    i2c_handle = 42;  // Simulated handle
-#else
-    // Ouvrir le périphérique I2C
-    char i2c_device[20];
-    snprintf(i2c_device, sizeof(i2c_device), "/dev/i2c-%d", i2c_bus);
-    
-    i2c_handle = open(i2c_device, O_RDWR);
-    if (i2c_handle < 0) {
-        set_error("Failed to open I2C device %s: %s", i2c_device, strerror(errno));
-        return TECHTEMP_ERROR;
-    }
-    
-    // Configurer l'adresse du périphérique I2C
-    if (ioctl(i2c_handle, I2C_SLAVE, address) < 0) {
-        set_error("Failed to configure I2C slave address: %s", strerror(errno));
-        close(i2c_handle);
-        i2c_handle = -1;
-        return TECHTEMP_ERROR;
+static inline void unpack_frame(const uint8_t* data, uint32_t* raw_humidity, uint32_t* raw_temperature) {
+    *raw_humidity = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | ((uint32_t)data[3] >> 4);
+    *raw_temperature = ((uint32_t)(data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | (uint32_t)data[5];
+}
+
+/**
+ * Conversion loop of aht20_decode_frames(), inlined with a constant frame
+ * length: branch-free, fixed stride and restrict outputs, so the compiler
+ * can unroll it and keep the integer arithmetic in vector registers
+ */
+static inline void convert_frames(const uint8_t* frames, size_t frame_length, size_t count,
+                                  int32_t* restrict temperature_centi, int32_t* restrict humidity_centi) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t raw_humidity, raw_temperature;
+        unpack_frame(frames + i * frame_length, &raw_humidity, &raw_temperature);
+        temperature_centi[i] = aht20_temperature_centi(raw_temperature);
+        humidity_centi[i] = aht20_humidity_centi(raw_humidity);
     }
-#endif
-    
-    LOG_DEBUG_F("I2C handle: %d", i2c_handle);
-    
-    // Wait for AHT20 to be ready (power-on time)
-    aht20_delay_ms(AHT20_POWERUP_DELAY_MS);
-    
-    // Perform soft reset
-#ifdef SIMULATION_MODE
-    // Simulation - always succeed
-#else
+}
+
+/**
+ * Soft reset, then calibration command (shared by init and reset)
+ */
+static int reset_and_calibrate(aht20_t* sensor) {
     uint8_t reset_cmd = AHT20_CMD_SOFTRESET;
-    if (write(i2c_handle, &reset_cmd, 1) != 1) {
-        set_error("Failed to send reset command: %s", strerror(errno));
+    if (!i2c_transfer(sensor, &reset_cmd, 1, NULL, 0)) {
+        set_error(sensor, "Failed to send reset command: %s", strerror(errno));
         return TECHTEMP_ERROR;
     }
-#endif
     
     // Wait for reset to complete
     aht20_delay_ms(AHT20_RESET_DELAY_MS);
     
     // Wait for sensor to not be busy
-    if (!aht20_wait_not_busy(AHT20_BUSY_TIMEOUT)) {
-        set_error("Timeout waiting for reset completion");
+    if (!aht20_wait_not_busy(sensor, AHT20_BUSY_TIMEOUT)) {
+        set_error(sensor, "Timeout waiting for reset completion");
         return TECHTEMP_TIMEOUT;
     }
     
     // Send calibration command (optional - some AHT20s don't need it)
     uint8_t cal_cmd[3] = {AHT20_CMD_CALIBRATE, 0x08, 0x00};
-    if (!write_i2c_block(cal_cmd, 3)) {
+    if (!i2c_transfer(sensor, cal_cmd, 3, NULL, 0)) {
         LOG_DEBUG_F("Calibration command failed (some AHT20s don't need it): %s", strerror(errno));
         // Continue anyway - many AHT20s work without explicit calibration
     } else {
         // Wait for calibration to complete
-        if (!aht20_wait_not_busy(AHT20_BUSY_TIMEOUT)) {
+        if (!aht20_wait_not_busy(sensor, AHT20_BUSY_TIMEOUT)) {
             LOG_DEBUG_F("Calibration timeout (continuing anyway)");
             // Continue anyway - the sensor might still work
         }
     }
     
     // Check calibration status (optional - some new AHT20s don't set this bit)
-    uint8_t status = aht20_get_status();
+    uint8_t status = aht20_get_status(sensor);
     LOG_DEBUG_F("Final status after calibration: 0x%02X", status);
+    sensor->calibration_reported = (status != 0xFF && (status & AHT20_STATUS_CALIBRATED));
+    return TECHTEMP_OK;
+}
+
+/**
+ * Select the I2C transport of the sensors initialized afterwards
+ */
+void aht20_set_transport(const i2c_transport_t* transport) {
+    current_transport = transport ? transport : &i2c_dev_transport;
+}
+
+/**
+ * Initialize AHT20 sensor
+ */
+int aht20_init(aht20_t* sensor, int i2c_bus, uint8_t address) {
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->i2c_handle = -1;
+    sensor->timer_fd = -1;
+    sensor->address = address;
+    sensor->transport = current_transport;
+    
+    if (!i2c_duration_metric) {
+        i2c_duration_metric = metric_register("techtemp_i2c_transfer_duration_us",
+                                              "Duration of one I2C_RDWR transfer", METRIC_HISTOGRAM);
+        busy_poll_metric = metric_register("techtemp_aht20_busy_polls_total",
+                                           "Status reads that found a conversion still running",
+                                           METRIC_COUNTER);
+        error_metric = metric_register("techtemp_i2c_errors_total",
+                                       "Rejected AHT20 transfers: I/O, CRC and status errors, timeouts",
+                                       METRIC_COUNTER);
+    }
+    
+    LOG_DEBUG_F("Initializing AHT20 on I2C bus %d, address 0x%02X", i2c_bus, address);
     
-    initialized = true;
+    // Ouvrir le bus I2C (/dev/i2c-N, ou capteur émulé)
+    sensor->i2c_handle = sensor->transport->open(i2c_bus, address);
+    if (sensor->i2c_handle < 0) {
+        set_error(sensor, "Failed to open I2C bus %d (%s): %s", i2c_bus, sensor->transport->name, strerror(errno));
+        sensor->i2c_handle = -1;
+        return TECHTEMP_ERROR;
+    }
+    
+    LOG_DEBUG_F("I2C handle: %d", sensor->i2c_handle);
+    
+    // Timer utilisé pour l'échéance de conversion (lecture non bloquante)
+    sensor->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (sensor->timer_fd < 0) {
+        set_error(sensor, "Failed to create conversion timer: %s", strerror(errno));
+        sensor->transport->close(sensor->i2c_handle);
+        sensor->i2c_handle = -1;
+        return TECHTEMP_ERROR;
+    }
+    
+    // Wait for AHT20 to be ready (power-on time)
+    aht20_delay_ms(AHT20_POWERUP_DELAY_MS);
+    
+    int result = reset_and_calibrate(sensor);
+    if (result != TECHTEMP_OK) {
+        return result;
+    }
+    
+    sensor->initialized = true;
     return TECHTEMP_OK;
 }
 
 /**
- * Read sensor data
+ * Start a measurement without waiting for completion
  */
-int aht20_read(sensor_reading_t* reading) {
-    if (!initialized || i2c_handle == -1) {
-        set_error("AHT20 not initialized");
+int aht20_trigger(aht20_t* sensor) {
+    if (!sensor->initialized || sensor->i2c_handle == -1) {
+        set_error(sensor, "AHT20 not initialized");
         return TECHTEMP_ERROR;
     }
     
-    if (!reading) {
-        set_error("Invalid reading buffer");
+    if (sensor->measuring) {
+        set_error(sensor, "Measurement already in progress");
         return TECHTEMP_ERROR;
     }
     
-    // Send measurement command
+    // Send measurement command (starts the per-reading I/O count)
+    TECHTEMP_PROBE1(aht20_trigger, sensor->address);
+    sensor->io_syscalls = 0;
+    sensor->io_transactions = 0;
+    sensor->frame_ready = false;
     uint8_t measure_cmd[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
-    if (!write_i2c_block(measure_cmd, 3)) {
-        set_error("Failed to send measurement command");
+    if (!i2c_transfer(sensor, measure_cmd, 3, NULL, 0)) {
+        set_error(sensor, "Failed to send measurement command");
         return TECHTEMP_ERROR;
     }
     
-    // Wait for measurement to complete
-    if (!aht20_wait_not_busy(AHT20_BUSY_TIMEOUT)) {
-        set_error("Timeout waiting for measurement completion");
-        return TECHTEMP_TIMEOUT;
+    // Pas de lecture de statut avant l'échéance datasheet
+    if (arm_timer(sensor, AHT20_CONVERSION_TIME_MS) != 0) {
+        set_error(sensor, "Failed to arm conversion timer: %s", strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    sensor->measuring = true;
+    sensor->deadline_reached = false;
+    sensor->busy_polls = 0;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Check whether the pending measurement is complete
+ */
+int aht20_poll_ready(aht20_t* sensor, bool* ready) {
+    if (!ready) {
+        set_error(sensor, "Invalid ready pointer");
+        return TECHTEMP_ERROR;
     }
     
-    // Read measurement data (6 bytes)
-    uint8_t data[6];
-    if (!read_i2c_block(data, 6)) {
-        set_error("Failed to read measurement data");
+    *ready = false;
+    
+    if (!sensor->measuring) {
+        set_error(sensor, "No measurement in progress");
         return TECHTEMP_ERROR;
     }
     
-    LOG_DEBUG_F("Raw bytes: %02X %02X %02X %02X %02X %02X", 
-                data[0], data[1], data[2], data[3], data[4], data[5]);
+    // Conversion deadline not reached yet: don't touch the bus
+    if (!sensor->deadline_reached) {
+        if (!timer_expired(sensor)) {
+            return TECHTEMP_OK;
+        }
+        sensor->deadline_reached = true;
+    }
     
-    // Extract humidity (based on Adafruit implementation)
-    uint32_t raw_humidity = data[1];
-    raw_humidity <<= 8;
-    raw_humidity |= data[2];
-    raw_humidity <<= 4;
-    raw_humidity |= data[3] >> 4;
+    // Status, data and CRC in one read: nothing left to fetch once not busy
+    if (!i2c_transfer(sensor, NULL, 0, sensor->frame, AHT20_FRAME_LENGTH)) {
+        sensor->measuring = false;
+        set_error(sensor, "Failed to read sensor status");
+        return TECHTEMP_ERROR;
+    }
+    TECHTEMP_PROBE3(aht20_poll, sensor->address, sensor->frame[0], sensor->busy_polls);
     
-    // Extract temperature (based on Adafruit implementation)
-    uint32_t raw_temperature = data[3] & 0x0F;
-    raw_temperature <<= 8;
-    raw_temperature |= data[4];
-    raw_temperature <<= 8;
-    raw_temperature |= data[5];
+    if (sensor->frame[0] & AHT20_STATUS_BUSY) {
+        // Still converting: re-arm a short retry deadline
+        metric_inc(busy_poll_metric);
+        if (++sensor->busy_polls >= AHT20_BUSY_TIMEOUT || arm_timer(sensor, AHT20_BUSY_RETRY_MS) != 0) {
+            sensor->measuring = false;
+            sensor->stats.timeouts++;
+            metric_inc(error_metric);
+            set_error(sensor, "Timeout waiting for measurement completion");
+            return TECHTEMP_TIMEOUT;
+        }
+        sensor->deadline_reached = false;
+        return TECHTEMP_OK;
+    }
+    
+    sensor->frame_ready = true;
+    *ready = true;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Read back the result of a completed measurement
+ */
+int aht20_collect(aht20_t* sensor, sensor_reading_t* reading) {
+    if (!reading) {
+        set_error(sensor, "Invalid reading buffer");
+        return TECHTEMP_ERROR;
+    }
+    
+    if (!sensor->measuring) {
+        set_error(sensor, "No measurement in progress");
+        return TECHTEMP_ERROR;
+    }
+    
+    sensor->measuring = false;
+    
+    // Frame normally fetched by aht20_poll_ready() (status + 5 data bytes + CRC)
+    if (!sensor->frame_ready && !i2c_transfer(sensor, NULL, 0, sensor->frame, AHT20_FRAME_LENGTH)) {
+        set_error(sensor, "Failed to read measurement data");
+        return TECHTEMP_ERROR;
+    }
+    sensor->frame_ready = false;
+    const uint8_t* data = sensor->frame;
+    
+    LOG_DEBUG_F("Raw bytes: %02X %02X %02X %02X %02X %02X (CRC %02X)", 
+                data[0], data[1], data[2], data[3], data[4], data[5], data[6]);
+    
+    // Integrity: CRC over status + data, then the status bits
+    uint8_t crc = aht20_crc8(data, AHT20_FRAME_LENGTH - 1);
+    if (crc != data[AHT20_FRAME_LENGTH - 1]) {
+        sensor->stats.crc_errors++;
+        metric_inc(error_metric);
+        TECHTEMP_PROBE3(aht20_collect, sensor->address, data[0], TECHTEMP_ERROR);
+        set_error(sensor, "CRC mismatch (computed 0x%02X, received 0x%02X)", crc, data[AHT20_FRAME_LENGTH - 1]);
+        return TECHTEMP_ERROR;
+    }
+    
+    // Calibration bit lost since init: the sensor reset itself (brown-out)
+    if ((data[0] & AHT20_STATUS_BUSY) ||
+        (sensor->calibration_reported && !(data[0] & AHT20_STATUS_CALIBRATED))) {
+        sensor->stats.status_errors++;
+        metric_inc(error_metric);
+        TECHTEMP_PROBE3(aht20_collect, sensor->address, data[0], TECHTEMP_ERROR);
+        set_error(sensor, "Unexpected sensor status 0x%02X", data[0]);
+        return TECHTEMP_ERROR;
+    }
+    
+    // Extract humidity and temperature (based on Adafruit implementation)
+    uint32_t raw_humidity, raw_temperature;
+    unpack_frame(data, &raw_humidity, &raw_temperature);
     
     // Calculate actual values
-    reading->temperature = calculate_temperature(raw_temperature);
-    reading->humidity = calculate_humidity(raw_humidity);
+    reading->temperature = aht20_calculate_temperature(raw_temperature);
+    reading->humidity = aht20_calculate_humidity(raw_humidity);
+    reading->temperature_centi = aht20_temperature_centi(raw_temperature);
+    reading->humidity_centi = aht20_humidity_centi(raw_humidity);
     reading->timestamp = get_timestamp_ms();
     reading->valid = true;
+    sensor->stats.readings++;
+    TECHTEMP_PROBE3(aht20_collect, sensor->address, data[0], TECHTEMP_OK);
     
-    LOG_DEBUG_F("Raw data - Humidity: 0x%06X, Temperature: 0x%06X", raw_humidity, raw_temperature);
+    LOG_DEBUG_F("Raw data - Humidity: 0x%06X, Temperature: 0x%06X (%d busy polls, "
+                "%d I2C syscalls, %d bus transactions)", raw_humidity, raw_temperature,
+                sensor->busy_polls, sensor->io_syscalls, sensor->io_transactions);
     LOG_DEBUG_F("Calculated - T: %.2f°C, H: %.2f%%", reading->temperature, reading->humidity);
     
     return TECHTEMP_OK;
 }
 
+/**
+ * Decode a batch of raw frames into separate output arrays
+ */
+size_t aht20_decode_frames(const uint8_t* frames, size_t frame_length, size_t count,
+                           int32_t* restrict temperature_centi, int32_t* restrict humidity_centi,
+                           uint8_t* restrict valid) {
+    if (frame_length == AHT20_FRAME_LENGTH) {
+        convert_frames(frames, AHT20_FRAME_LENGTH, count, temperature_centi, humidity_centi);
+    } else if (frame_length == AHT20_FRAME_LENGTH - 1) {
+        convert_frames(frames, AHT20_FRAME_LENGTH - 1, count, temperature_centi, humidity_centi);
+    } else {
+        return 0;
+    }
+    
+    if (valid == NULL) {
+        return count;
+    }
+    
+    // Integrity pass, kept apart so it does not block the vectorized loop
+    size_t valid_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* data = frames + i * frame_length;
+        bool ok = !(data[0] & AHT20_STATUS_BUSY);
+        if (ok && frame_length == AHT20_FRAME_LENGTH) {
+            ok = (aht20_crc8(data, AHT20_FRAME_LENGTH - 1) == data[AHT20_FRAME_LENGTH - 1]);
+        }
+        valid[i] = ok;
+        valid_count += ok;
+    }
+    return valid_count;
+}
+
+/**
+ * Soft reset and re-initialize the sensor
+ */
+int aht20_reset(aht20_t* sensor) {
+    if (sensor->i2c_handle == -1 || sensor->timer_fd == -1) {
+        set_error(sensor, "AHT20 not initialized");
+        return TECHTEMP_ERROR;
+    }
+    
+    aht20_cancel(sensor);
+    sensor->initialized = false;
+    sensor->stats.resets++;
+    
+    int result = reset_and_calibrate(sensor);
+    if (result != TECHTEMP_OK) {
+        return result;
+    }
+    
+    sensor->initialized = true;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Check if a measurement is in progress
+ */
+int aht20_is_busy(aht20_t* sensor, bool* busy) {
+    if (!busy) {
+        set_error(sensor, "Invalid busy pointer");
+        return TECHTEMP_ERROR;
+    }
+    
+    uint8_t status = aht20_get_status(sensor);
+    if (status == 0xFF) {
+        set_error(sensor, "Failed to read sensor status");
+        return TECHTEMP_ERROR;
+    }
+    *busy = (status & AHT20_STATUS_BUSY) != 0;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Check if the sensor reports its calibration
+ */
+int aht20_is_calibrated(aht20_t* sensor, bool* calibrated) {
+    if (!calibrated) {
+        set_error(sensor, "Invalid calibrated pointer");
+        return TECHTEMP_ERROR;
+    }
+    
+    uint8_t status = aht20_get_status(sensor);
+    if (status == 0xFF) {
+        set_error(sensor, "Failed to read sensor status");
+        return TECHTEMP_ERROR;
+    }
+    *calibrated = (status & AHT20_STATUS_CALIBRATED) != 0;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Get the integrity counters
+ */
+const aht20_stats_t* aht20_get_stats(const aht20_t* sensor) {
+    return &sensor->stats;
+}
+
+/**
+ * Read sensor data (blocking: trigger, wait on the conversion timer, collect)
+ */
+int aht20_read(aht20_t* sensor, sensor_reading_t* reading) {
+    if (!reading) {
+        set_error(sensor, "Invalid reading buffer");
+        return TECHTEMP_ERROR;
+    }
+    
+    int result = aht20_trigger(sensor);
+    if (result != TECHTEMP_OK) {
+        return result;
+    }
+    
+    bool ready = false;
+    while (!ready) {
+        struct pollfd pfd = { .fd = sensor->timer_fd, .events = POLLIN };
+        if (poll(&pfd, 1, AHT20_MEASURE_DELAY_MS) < 0 && errno != EINTR) {
+            sensor->measuring = false;
+            set_error(sensor, "Failed to wait for conversion timer: %s", strerror(errno));
+            return TECHTEMP_ERROR;
+        }
+        
+        result = aht20_poll_ready(sensor, &ready);
+        if (result != TECHTEMP_OK) {
+            return result;
+        }
+    }
+    
+    return aht20_collect(sensor, reading);
+}
+
+/**
+ * Abandon the pending measurement
+ */
+void aht20_cancel(aht20_t* sensor) {
+    if (sensor->timer_fd != -1) {
+        arm_timer(sensor, 0);
+    }
+    sensor->measuring = false;
+    sensor->deadline_reached = false;
+    sensor->frame_ready = false;
+}
+
+/**
+ * Get conversion timer file descriptor
+ */
+int aht20_get_timer_fd(const aht20_t* sensor) {
+    return sensor->timer_fd;
+}
+
 /**
  * Get last error message
  */
-const char* aht20_get_error(void) {
-    return last_error;
+const char* aht20_get_error(const aht20_t* sensor) {
+    return sensor->last_error;
 }
 
 /**
  * Cleanup AHT20 resources
  */
-void aht20_cleanup(void) {
+void aht20_cleanup(aht20_t* sensor) {
     LOG_DEBUG_F("Cleaning up AHT20 resources");
     
-    if (i2c_handle != -1) {
-#ifndef SIMULATION_MODE
-        close(i2c_handle);
-#endif
-        i2c_handle = -1;
+    if (sensor->i2c_handle != -1) {
+        sensor->transport->close(sensor->i2c_handle);
+        sensor->i2c_handle = -1;
+    }
+    
+    if (sensor->timer_fd != -1) {
+        close(sensor->timer_fd);
+        sensor->timer_fd = -1;
     }
     
-    initialized = false;
-    last_error[0] = '\0';
+    sensor->initialized = false;
+    sensor->measuring = false;
+    sensor->last_error[0] = '\0';
 }
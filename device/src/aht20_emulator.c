@@ -0,0 +1,271 @@
+/**
+ * @file aht20_emulator.c
+ * @brief Emulated AHT20 behind the I2C transport interface
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#define _DEFAULT_SOURCE  // Pour M_PI et clock_nanosleep()
+#include "aht20_emulator.h"
+#include "aht20.h"
+#include "schedule.h"
+#include <math.h>
+
+#define EMULATOR_CMD_CALIBRATE  0xE1    // AHT10-style calibration, also sent by the driver
+#define EMULATOR_DATA_LENGTH    5       // Humidity and temperature counts (20 bits each)
+#define EMULATOR_RAW_MAX        0xFFFFF
+
+// One emulated device (touched by its bus thread only once opened)
+typedef struct {
+    bool in_use;
+    int i2c_bus;
+    uint8_t address;
+    aht20_emulator_config_t config;
+    bool calibrated;                           // Cleared by a brown-out, set by reset/calibration
+    bool converting;
+    uint64_t busy_until_us;                    // Busy bit set until then
+    uint8_t data[EMULATOR_DATA_LENGTH];        // Last completed conversion (read while busy too)
+    uint8_t pending[EMULATOR_DATA_LENGTH];     // Conversion in progress
+    uint64_t random_state;                     // xorshift64*
+    double phase;                              // Waveform phase of this device
+    
+    // Work done and faults injected, logged at close
+    uint32_t conversions;
+    uint32_t nacks;
+    uint32_t bus_errors;
+    uint32_t crc_errors;
+    uint32_t brownouts;
+} emulated_device_t;
+
+static emulated_device_t devices[MAX_SENSORS];
+static aht20_emulator_config_t current_config = {
+    .conversion_ms = 80,
+    .conversion_jitter_ms = 10,
+    .bus_khz = 100,
+    .period_seconds = 86400,
+    .seed = 1
+};
+
+// Internal helper functions
+static int emulator_open(int i2c_bus, uint8_t address);
+static int emulator_transfer(int handle, uint8_t address, uint8_t* tx, int tx_length, uint8_t* rx, int rx_length);
+static void emulator_close(int handle);
+static void run_command(emulated_device_t* device, const uint8_t* tx, int tx_length, uint64_t now_us);
+static void read_frame(emulated_device_t* device, uint8_t* rx, int rx_length, uint64_t now_us);
+static void sample_waveform(emulated_device_t* device, uint8_t* data);
+static void bus_delay(const emulated_device_t* device, int tx_length, int rx_length);
+static uint64_t next_random(emulated_device_t* device);
+static double random_unit(emulated_device_t* device);
+static bool chance(emulated_device_t* device, float rate);
+
+const i2c_transport_t aht20_emulator_transport = {
+    .name = "emulator",
+    .open = emulator_open,
+    .transfer = emulator_transfer,
+    .close = emulator_close
+};
+
+/**
+ * Set the behaviour of the devices opened afterwards
+ */
+void aht20_emulator_configure(const aht20_emulator_config_t* config) {
+    if (config) {
+        current_config = *config;
+    }
+}
+
+// Internal helper functions
+
+static int emulator_open(int i2c_bus, uint8_t address) {
+    for (int handle = 0; handle < MAX_SENSORS; handle++) {
+        emulated_device_t* device = &devices[handle];
+        if (device->in_use) {
+            continue;
+        }
+        
+        // Powered up, calibrated and idle (status 0x08)
+        memset(device, 0, sizeof(*device));
+        device->in_use = true;
+        device->i2c_bus = i2c_bus;
+        device->address = address;
+        device->config = current_config;
+        device->calibrated = true;
+        device->random_state = ((uint64_t)current_config.seed + 1) * 0x9E3779B97F4A7C15ULL ^ (uint64_t)(handle + 1);
+        device->phase = 0.3 * handle;  // Rooms of one house: close but not identical
+        sample_waveform(device, device->data);
+        
+        LOG_DEBUG_F("Emulated AHT20 0x%02X on bus %d (handle %d)", address, i2c_bus, handle);
+        return handle;
+    }
+    
+    errno = EMFILE;
+    return -1;
+}
+
+static int emulator_transfer(int handle, uint8_t address, uint8_t* tx, int tx_length, uint8_t* rx, int rx_length) {
+    if (handle < 0 || handle >= MAX_SENSORS || !devices[handle].in_use) {
+        errno = EBADF;
+        return -1;
+    }
+    emulated_device_t* device = &devices[handle];
+    
+    // The transaction occupies the bus whatever its outcome
+    bus_delay(device, tx_length, rx_length);
+    
+    if (address != device->address || chance(device, device->config.nack_rate)) {
+        device->nacks++;
+        errno = EREMOTEIO;
+        return -1;
+    }
+    if (chance(device, device->config.error_rate)) {
+        device->bus_errors++;
+        errno = EIO;
+        return -1;
+    }
+    
+    uint64_t now_us = schedule_monotonic_us();
+    if (device->converting && now_us >= device->busy_until_us) {
+        memcpy(device->data, device->pending, sizeof(device->data));
+        device->converting = false;
+    }
+    
+    if (tx_length > 0) {
+        run_command(device, tx, tx_length, now_us);
+    }
+    if (rx_length > 0) {
+        read_frame(device, rx, rx_length, now_us);
+    }
+    return 0;
+}
+
+static void emulator_close(int handle) {
+    if (handle < 0 || handle >= MAX_SENSORS || !devices[handle].in_use) {
+        return;
+    }
+    emulated_device_t* device = &devices[handle];
+    
+    LOG_INFO_F("Emulated AHT20 0x%02X on bus %d: %u conversions, %u NACKs, %u bus errors, "
+               "%u corrupted frames, %u brown-outs", device->address, device->i2c_bus,
+               device->conversions, device->nacks, device->bus_errors, device->crc_errors, device->brownouts);
+    device->in_use = false;
+}
+
+static void run_command(emulated_device_t* device, const uint8_t* tx, int tx_length, uint64_t now_us) {
+    switch (tx[0]) {
+        case AHT20_CMD_RESET:
+            device->calibrated = true;
+            device->converting = false;
+            device->busy_until_us = now_us + AHT20_EMULATOR_RESET_MS * 1000ULL;
+            break;
+        case AHT20_CMD_INIT:
+        case EMULATOR_CMD_CALIBRATE:
+            device->calibrated = true;
+            device->busy_until_us = now_us + AHT20_EMULATOR_CALIBRATION_MS * 1000ULL;
+            break;
+        case AHT20_CMD_MEASURE:
+            if (tx_length < 3 || device->converting) {
+                break;  // Incomplete command, or ignored while converting
+            }
+            device->conversions++;
+            if (chance(device, device->config.brownout_rate)) {
+                // Supply dip: the sensor restarts uncalibrated until the next soft reset
+                device->brownouts++;
+                device->calibrated = false;
+            }
+            
+            // Sampled now, visible once the conversion time has elapsed
+            sample_waveform(device, device->pending);
+            device->converting = true;
+            device->busy_until_us = now_us + (uint64_t)device->config.conversion_ms * 1000ULL +
+                                    (uint64_t)(random_unit(device) * device->config.conversion_jitter_ms * 1000.0);
+            break;
+        default:
+            break;  // Status command (0x71) and unknown commands: nothing to do
+    }
+}
+
+static void read_frame(emulated_device_t* device, uint8_t* rx, int rx_length, uint64_t now_us) {
+    uint8_t frame[AHT20_FRAME_LENGTH];
+    frame[0] = (now_us < device->busy_until_us ? AHT20_STATUS_BUSY : 0) |
+               (device->calibrated ? AHT20_STATUS_CALIBRATED : 0);
+    memcpy(frame + 1, device->data, sizeof(device->data));
+    frame[AHT20_FRAME_LENGTH - 1] = aht20_crc8(frame, AHT20_FRAME_LENGTH - 1);
+    
+    // Corrupted on the wire: one data bit flipped after the CRC was computed
+    if (rx_length >= AHT20_FRAME_LENGTH && chance(device, device->config.crc_error_rate)) {
+        uint64_t bits = next_random(device);
+        frame[1 + bits % EMULATOR_DATA_LENGTH] ^= (uint8_t)(1u << ((bits >> 8) % 8));
+        device->crc_errors++;
+    }
+    
+    // Past the frame the bus reads back 0xFF (pulled-up SDA)
+    int length = rx_length < AHT20_FRAME_LENGTH ? rx_length : AHT20_FRAME_LENGTH;
+    memcpy(rx, frame, (size_t)length);
+    if (rx_length > length) {
+        memset(rx + length, 0xFF, (size_t)(rx_length - length));
+    }
+}
+
+static void sample_waveform(emulated_device_t* device, uint8_t* data) {
+    // Wall clock: the same curve across restarts (a day by default)
+    int period = device->config.period_seconds > 0 ? device->config.period_seconds : 86400;
+    double seconds = (double)(get_timestamp_ms() % ((uint64_t)period * 1000)) / 1000.0;
+    double wave = sin(2.0 * M_PI * seconds / period + device->phase);
+    
+    // Triangular noise in [-1, 1]; humidity falls when the room warms up
+    double temperature = AHT20_EMULATOR_TEMPERATURE_MEAN + AHT20_EMULATOR_TEMPERATURE_AMPLITUDE * wave +
+                         AHT20_EMULATOR_TEMPERATURE_NOISE * (random_unit(device) + random_unit(device) - 1.0);
+    double humidity = AHT20_EMULATOR_HUMIDITY_MEAN - AHT20_EMULATOR_HUMIDITY_AMPLITUDE * wave +
+                      AHT20_EMULATOR_HUMIDITY_NOISE * (random_unit(device) + random_unit(device) - 1.0);
+    
+    // Inverse of the datasheet conversions, 20-bit counts
+    double raw_temperature = (temperature + 50.0) / 200.0 * AHT20_TEMPERATURE_MAX;
+    double raw_humidity = humidity / 100.0 * AHT20_HUMIDITY_MAX;
+    uint32_t temperature_count = (uint32_t)fmin(fmax(raw_temperature, 0.0), EMULATOR_RAW_MAX);
+    uint32_t humidity_count = (uint32_t)fmin(fmax(raw_humidity, 0.0), EMULATOR_RAW_MAX);
+    
+    data[0] = (uint8_t)(humidity_count >> 12);
+    data[1] = (uint8_t)(humidity_count >> 4);
+    data[2] = (uint8_t)(((humidity_count & 0x0F) << 4) | (temperature_count >> 16));
+    data[3] = (uint8_t)(temperature_count >> 8);
+    data[4] = (uint8_t)temperature_count;
+}
+
+static void bus_delay(const emulated_device_t* device, int tx_length, int rx_length) {
+    if (device->config.bus_khz <= 0) {
+        return;
+    }
+    
+    // 9 clocks per byte (8 bits + ACK), address byte of each message, START/STOP
+    int bits = 2;
+    if (tx_length > 0) {
+        bits += 9 * (tx_length + 1);
+    }
+    if (rx_length > 0) {
+        bits += 9 * (rx_length + 1);
+    }
+    
+    uint64_t delay_ns = (uint64_t)bits * 1000000ULL / (uint64_t)device->config.bus_khz;
+    struct timespec delay = { .tv_sec = (time_t)(delay_ns / 1000000000ULL),
+                              .tv_nsec = (long)(delay_ns % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &delay, &delay) == EINTR) {
+        // Interrupted: sleep the remainder
+    }
+}
+
+static uint64_t next_random(emulated_device_t* device) {
+    uint64_t x = device->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    device->random_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static double random_unit(emulated_device_t* device) {
+    return (double)(next_random(device) >> 11) * (1.0 / 9007199254740992.0);  // [0, 1), 53 bits
+}
+
+static bool chance(emulated_device_t* device, float rate) {
+    return rate > 0.0f && random_unit(device) < rate;
+}
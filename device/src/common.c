@@ -7,6 +7,7 @@
 
 #define _GNU_SOURCE  // Pour strdup()
 #include "common.h"
+#include "log_trace.h"
 #include <time.h>
 #include <sys/time.h>
 #include <stdarg.h>
@@ -21,16 +22,77 @@
 #include <stdio.h>  // Pour fileno()
 #include <limits.h> // Pour HOST_NAME_MAX
 #include <inttypes.h> // Pour PRIu64
+#include <pthread.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 
 // Global log level
 static log_level_t current_log_level = LOG_LEVEL_INFO;
 static FILE* log_file = NULL;
 static bool log_to_console = true;
+static int log_color = -1;           // Console is a terminal (-1 = not checked yet)
+
+// Asynchronous logging: bounded MPSC ring drained by a writer thread
+#define LOG_RING_SLOTS   256         // Power of two
+#define LOG_MESSAGE_MAX  256         // Longer messages are truncated
+#define LOG_LINE_MAX     (LOG_MESSAGE_MAX + 128)
+#define LOG_WRITE_BATCH  32          // Lines per writev()
+
+typedef struct {
+    uint32_t sequence;               // Slot state (bounded queue turn counter)
+    log_level_t level;
+    int line;
+    const char* file;
+    time_t timestamp;
+    uint16_t length;
+    char message[LOG_MESSAGE_MAX];
+} log_slot_t;
+
+// Formatted lines waiting for one writev() per destination
+typedef struct {
+    char lines[LOG_WRITE_BATCH][LOG_LINE_MAX];
+    size_t lengths[LOG_WRITE_BATCH];
+    log_level_t levels[LOG_WRITE_BATCH];
+    int count;
+} log_batch_t;
+
+static log_slot_t log_ring[LOG_RING_SLOTS];
+static uint32_t log_enqueue_pos = 0; // Shared by producers (CAS)
+static uint32_t log_dequeue_pos = 0; // Writer thread only
+static uint64_t log_dropped_count = 0;
+static bool log_block_when_full = false;
+static bool writer_running = false;
+static bool writer_stopping = false;
+static bool writer_sleeping = false;
+static int writer_wake_fd = -1;
+static pthread_t writer_thread;
+static log_batch_t write_batch;      // Writer thread only
+
+// Metrics registry: an entry is immutable once published through metrics_count
+static metric_t metrics[MAX_METRICS];
+static int metrics_count = 0;
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;  // Registration only
 
 // Internal helper functions
 static const char* log_level_to_string(log_level_t level);
 static const char* log_level_to_color(log_level_t level);
-static void write_log_message(log_level_t level, const char* file, int line, const char* message);
+static void enqueue_message(log_level_t level, const char* file, int line, const char* format, va_list args);
+static log_slot_t* claim_slot(void);
+static void wake_writer(bool force);
+static void* writer_main(void* arg);
+static int drain_ring(void);
+static void stop_writer(void);
+static void format_timestamp(time_t timestamp, char* buffer, size_t buffer_size);
+static const char* cached_timestamp(time_t timestamp);
+static int format_line(char* log_line, const char* timestamp_text, log_level_t level, const char* file,
+                       int line, const char* message, size_t length);
+static void batch_add(log_batch_t* batch, log_level_t level, const char* file, int line,
+                      time_t timestamp, const char* message, size_t length);
+static void batch_flush(log_batch_t* batch);
+static void write_lines(char (*lines)[LOG_LINE_MAX], const size_t* lengths, const log_level_t* levels, int count);
+static void write_iov(int fd, struct iovec* iov, int count);
+static int metric_bucket_index(uint64_t value);
 
 /**
  * Get current timestamp in milliseconds
@@ -85,6 +147,7 @@ void get_timestamp_local(char* buffer, size_t buffer_size) {
 int log_init(log_level_t level, const char* log_file_path, bool console_output) {
     current_log_level = level;
     log_to_console = console_output;
+    log_color = isatty(STDERR_FILENO);  // Before any thread logs
     
     // Close existing log file if open
     if (log_file && log_file != stdout && log_file != stderr) {
@@ -134,26 +197,109 @@ log_level_t log_get_level(void) {
  * Write log message
  */
 void log_write(log_level_t level, const char* file, int line, const char* format, ...) {
-    if (level > current_log_level) {
+    va_list args;
+    
+    // Trace log: raw arguments only, formatted offline by techtemp-logdump
+    if ((int)level >= __atomic_load_n(&log_trace_threshold, __ATOMIC_RELAXED)) {
+        va_start(args, format);
+        log_trace_record(level, file, line, format, args);
+        va_end(args);
+    }
+    
+    // Filter before formatting: disabled levels cost no vsnprintf
+    if (level < current_log_level) {
         return;
     }
     
-    va_list args;
     va_start(args, format);
     
-    char message[1024];
-    vsnprintf(message, sizeof(message), format, args);
-    message[sizeof(message) - 1] = '\0';
+    if (__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE)) {
+        // Hot path: format into a ring slot, the writer thread does the I/O
+        enqueue_message(level, file, line, format, args);
+    } else {
+        // Any thread, possibly while the writer drains: stack buffers only
+        char message[LOG_MESSAGE_MAX];
+        int length = vsnprintf(message, sizeof(message), format, args);
+        if (length < 0) {
+            length = 0;
+        } else if (length >= (int)sizeof(message)) {
+            length = sizeof(message) - 1;
+        }
+        
+        char timestamp_text[32];
+        char log_line[1][LOG_LINE_MAX];
+        format_timestamp(time(NULL), timestamp_text, sizeof(timestamp_text));
+        int line_length = format_line(log_line[0], timestamp_text, level, file, line, message, (size_t)length);
+        if (line_length >= 0) {
+            size_t line_size = (size_t)line_length;
+            write_lines(log_line, &line_size, &level, 1);
+        }
+    }
     
     va_end(args);
+}
+
+/**
+ * Start the background log writer
+ */
+int log_start_async(bool block_when_full) {
+    if (__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE)) {
+        return TECHTEMP_OK;
+    }
+    
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+        log_ring[i].sequence = i;
+    }
+    log_enqueue_pos = 0;
+    log_dequeue_pos = 0;
+    log_block_when_full = block_when_full;
+    writer_stopping = false;
+    writer_sleeping = false;
+    
+    writer_wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (writer_wake_fd < 0) {
+        LOG_WARN_F("Failed to create log writer eventfd: %s, logging synchronously", strerror(errno));
+        return TECHTEMP_ERROR;
+    }
     
-    write_log_message(level, file, line, message);
+    // The writer must never receive process signals (they go to the signalfd)
+    sigset_t all_signals, previous;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &previous);
+    int result = pthread_create(&writer_thread, NULL, writer_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    
+    if (result != 0) {
+        close(writer_wake_fd);
+        writer_wake_fd = -1;
+        LOG_WARN_F("Failed to start log writer thread: %s, logging synchronously", strerror(result));
+        return TECHTEMP_ERROR;
+    }
+    
+    // Early exits (return from main) must still flush the ring
+    static bool exit_handler_registered = false;
+    if (!exit_handler_registered) {
+        atexit(stop_writer);
+        exit_handler_registered = true;
+    }
+    
+    __atomic_store_n(&writer_running, true, __ATOMIC_RELEASE);
+    return TECHTEMP_OK;
+}
+
+/**
+ * Get the number of log messages dropped because the ring was full
+ */
+uint64_t log_dropped(void) {
+    return __atomic_load_n(&log_dropped_count, __ATOMIC_RELAXED);
 }
 
 /**
  * Cleanup logging system
  */
 void log_cleanup(void) {
+    stop_writer();
+    
     if (log_file && log_file != stdout && log_file != stderr) {
         // Write shutdown message
         char timestamp[32];
@@ -165,6 +311,170 @@ void log_cleanup(void) {
     }
 }
 
+/**
+ * Register a metric, or get the one already registered under this name
+ */
+metric_t* metric_register(const char* name, const char* help, metric_type_t type) {
+    metric_t* metric = NULL;
+    
+    pthread_mutex_lock(&metrics_mutex);
+    for (int i = 0; i < metrics_count; i++) {
+        if (strcmp(metrics[i].name, name) == 0) {
+            metric = &metrics[i];
+            break;
+        }
+    }
+    if (!metric && metrics_count < MAX_METRICS) {
+        metric = &metrics[metrics_count];
+        memset(metric, 0, sizeof(*metric));
+        metric->name = name;
+        metric->help = help;
+        metric->type = type;
+        __atomic_store_n(&metrics_count, metrics_count + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&metrics_mutex);
+    
+    if (!metric) {
+        LOG_WARN_F("Metrics registry full, %s not recorded", name);
+    }
+    return metric;
+}
+
+/**
+ * Increment a counter
+ */
+void metric_inc(metric_t* metric) {
+    if (metric) {
+        __atomic_fetch_add(&metric->value, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Add to a counter or gauge
+ */
+void metric_add(metric_t* metric, int64_t delta) {
+    if (metric) {
+        __atomic_fetch_add(&metric->value, delta, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Set a gauge
+ */
+void metric_set(metric_t* metric, int64_t value) {
+    if (metric) {
+        __atomic_store_n(&metric->value, value, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Record one histogram observation
+ */
+void metric_observe(metric_t* metric, uint64_t value) {
+    if (metric) {
+        __atomic_fetch_add(&metric->buckets[metric_bucket_index(value)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&metric->sum, value, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&metric->count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Read a counter or gauge
+ */
+int64_t metric_value(const metric_t* metric) {
+    return metric ? __atomic_load_n(&metric->value, __ATOMIC_RELAXED) : 0;
+}
+
+/**
+ * Estimate a percentile of a histogram (upper bound of its bucket)
+ */
+uint64_t metric_percentile(const metric_t* metric, int percent) {
+    uint64_t count = metric ? __atomic_load_n(&metric->count, __ATOMIC_RELAXED) : 0;
+    if (count == 0) {
+        return 0;
+    }
+    
+    uint64_t rank = (count * (uint64_t)percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < METRIC_HISTOGRAM_BUCKETS - 1; i++) {
+        seen += __atomic_load_n(&metric->buckets[i], __ATOMIC_RELAXED);
+        if (seen >= rank) {
+            return metric_bucket_bound(i);
+        }
+    }
+    return metric_bucket_bound(METRIC_HISTOGRAM_BUCKETS - 1);
+}
+
+/**
+ * Get the number of registered metrics
+ */
+int metric_count(void) {
+    return __atomic_load_n(&metrics_count, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Get a registered metric (read its values with __atomic_load_n)
+ */
+const metric_t* metric_get(int index) {
+    if (index < 0 || index >= metric_count()) {
+        return NULL;
+    }
+    return &metrics[index];
+}
+
+/**
+ * Find a registered metric by name
+ */
+const metric_t* metric_find(const char* name) {
+    for (int i = 0; i < metric_count(); i++) {
+        if (strcmp(metrics[i].name, name) == 0) {
+            return &metrics[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Get the inclusive upper bound of a histogram bucket
+ */
+uint64_t metric_bucket_bound(int bucket) {
+    if (bucket >= METRIC_HISTOGRAM_BUCKETS - 1) {
+        return UINT64_MAX;
+    }
+    if (bucket < 2) {
+        return (uint64_t)bucket;
+    }
+    
+    // Bucket 2e + h covers [2^e + h * 2^(e-1), 2^e + (h + 1) * 2^(e-1))
+    int exponent = bucket / 2;
+    uint64_t half = (uint64_t)(bucket % 2);
+    return (UINT64_C(1) << exponent) + ((half + 1) << (exponent - 1)) - 1;
+}
+
+/**
+ * Log the metrics that recorded something (shutdown summary)
+ */
+void metrics_log(void) {
+    for (int i = 0; i < metric_count(); i++) {
+        const metric_t* metric = &metrics[i];
+        if (metric->type != METRIC_HISTOGRAM) {
+            int64_t value = metric_value(metric);
+            if (value != 0) {
+                LOG_INFO_F("Metric %s = %" PRId64, metric->name, value);
+            }
+            continue;
+        }
+        
+        uint64_t count = __atomic_load_n(&metric->count, __ATOMIC_RELAXED);
+        if (count > 0) {
+            uint64_t sum = __atomic_load_n(&metric->sum, __ATOMIC_RELAXED);
+            LOG_INFO_F("Metric %s: %" PRIu64 " observations, mean %" PRIu64 ", p50 <= %" PRIu64
+                       ", p99 <= %" PRIu64, metric->name, count, sum / count,
+                       metric_percentile(metric, 50), metric_percentile(metric, 99));
+        }
+    }
+}
+
 /**
  * Trim whitespace from string
  */
@@ -449,41 +759,283 @@ static const char* log_level_to_color(log_level_t level) {
     }
 }
 
-static void write_log_message(log_level_t level, const char* file, int line, const char* message) {
-    char timestamp[32];
-    get_timestamp_local(timestamp, sizeof(timestamp));
+static void enqueue_message(log_level_t level, const char* file, int line, const char* format, va_list args) {
+    log_slot_t* slot = claim_slot();
+    if (!slot) {
+        __atomic_fetch_add(&log_dropped_count, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    
+    slot->level = level;
+    slot->file = file;
+    slot->line = line;
+    slot->timestamp = time(NULL);
+    int length = vsnprintf(slot->message, sizeof(slot->message), format, args);
+    if (length < 0) {
+        length = 0;
+    } else if (length >= (int)sizeof(slot->message)) {
+        length = sizeof(slot->message) - 1;
+    }
+    slot->length = (uint16_t)length;
+    
+    // Publish the slot (sequence = claimed position + 1), then wake the writer
+    __atomic_store_n(&slot->sequence, slot->sequence + 1, __ATOMIC_SEQ_CST);
+    wake_writer(false);
+}
+
+static log_slot_t* claim_slot(void) {
+    uint32_t position = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+    
+    while (true) {
+        log_slot_t* slot = &log_ring[position & (LOG_RING_SLOTS - 1)];
+        uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int32_t difference = (int32_t)(sequence - position);
+        
+        if (difference == 0) {
+            // Free slot for this turn: take it unless another producer did
+            if (__atomic_compare_exchange_n(&log_enqueue_pos, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                return slot;
+            }
+        } else if (difference < 0) {
+            // Ring full: the writer has not released this slot yet
+            if (!log_block_when_full) {
+                return NULL;
+            }
+            wake_writer(true);
+            struct timespec pause = { 0, 100000 };  // 100 µs
+            nanosleep(&pause, NULL);
+            position = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+        } else {
+            position = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void wake_writer(bool force) {
+    // Only pay for the eventfd write when the writer actually sleeps
+    if (force || (__atomic_load_n(&writer_sleeping, __ATOMIC_SEQ_CST) &&
+                  __atomic_exchange_n(&writer_sleeping, false, __ATOMIC_SEQ_CST))) {
+        uint64_t one = 1;
+        if (write(writer_wake_fd, &one, sizeof(one)) < 0) {
+            // Counter saturated: the writer is awake anyway
+        }
+    }
+}
+
+static void* writer_main(void* arg) {
+    (void)arg;
+    uint64_t reported_dropped = 0;
+    
+    while (true) {
+        int drained = drain_ring();
+        
+        uint64_t dropped = __atomic_load_n(&log_dropped_count, __ATOMIC_RELAXED);
+        if (dropped != reported_dropped) {
+            char message[LOG_MESSAGE_MAX];
+            int length = snprintf(message, sizeof(message), "%" PRIu64 " log messages dropped (ring full)",
+                                  dropped - reported_dropped);
+            batch_add(&write_batch, LOG_LEVEL_WARN, __FILE__, __LINE__, time(NULL), message, (size_t)length);
+            batch_flush(&write_batch);
+            reported_dropped = dropped;
+        }
+        
+        if (drained > 0) {
+            continue;
+        }
+        if (__atomic_load_n(&writer_stopping, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        
+        // Announce the sleep, then re-check so a concurrent publish is not missed
+        __atomic_store_n(&writer_sleeping, true, __ATOMIC_SEQ_CST);
+        const log_slot_t* next = &log_ring[log_dequeue_pos & (LOG_RING_SLOTS - 1)];
+        if (__atomic_load_n(&next->sequence, __ATOMIC_SEQ_CST) == log_dequeue_pos + 1) {
+            __atomic_store_n(&writer_sleeping, false, __ATOMIC_SEQ_CST);
+            continue;
+        }
+        
+        uint64_t wakeups;
+        if (read(writer_wake_fd, &wakeups, sizeof(wakeups)) < 0 && errno != EINTR) {
+            break;
+        }
+        __atomic_store_n(&writer_sleeping, false, __ATOMIC_SEQ_CST);
+    }
+    
+    return NULL;
+}
+
+static int drain_ring(void) {
+    int count = 0;
+    
+    while (count < LOG_WRITE_BATCH) {
+        log_slot_t* slot = &log_ring[log_dequeue_pos & (LOG_RING_SLOTS - 1)];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != log_dequeue_pos + 1) {
+            break;
+        }
+        
+        batch_add(&write_batch, slot->level, slot->file, slot->line, slot->timestamp,
+                  slot->message, slot->length);
+        
+        // Hand the slot back to producers for the next turn
+        __atomic_store_n(&slot->sequence, log_dequeue_pos + LOG_RING_SLOTS, __ATOMIC_RELEASE);
+        log_dequeue_pos++;
+        count++;
+    }
+    
+    if (count > 0) {
+        batch_flush(&write_batch);
+    }
+    return count;
+}
+
+static void stop_writer(void) {
+    if (!__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    
+    // New messages go back to the synchronous path; the writer drains the rest
+    __atomic_store_n(&writer_running, false, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&writer_stopping, true, __ATOMIC_SEQ_CST);
+    wake_writer(true);
+    pthread_join(writer_thread, NULL);
     
+    close(writer_wake_fd);
+    writer_wake_fd = -1;
+}
+
+static void format_timestamp(time_t timestamp, char* buffer, size_t buffer_size) {
+    struct tm local_tm;
+    if (localtime_r(&timestamp, &local_tm)) {
+        strftime(buffer, buffer_size, "%Y-%m-%d %H:%M:%S", &local_tm);
+    } else {
+        snprintf(buffer, buffer_size, "1970-01-01 00:00:00");
+    }
+}
+
+static const char* cached_timestamp(time_t timestamp) {
+    // Writer thread only: localtime_r() + strftime() once per second, not once per line
+    static time_t cached_second = (time_t)-1;
+    static char cached_text[32] = "1970-01-01 00:00:00";
+    
+    if (timestamp != cached_second) {
+        format_timestamp(timestamp, cached_text, sizeof(cached_text));
+        cached_second = timestamp;
+    }
+    return cached_text;
+}
+
+static int format_line(char* log_line, const char* timestamp_text, log_level_t level, const char* file,
+                       int line, const char* message, size_t length) {
     // Extract filename from path
     const char* filename = strrchr(file, '/');
     filename = filename ? filename + 1 : file;
     
     // Format log message
-    char log_line[1024];
-    #pragma GCC diagnostic push
-    #pragma GCC diagnostic ignored "-Wformat-truncation"
-    snprintf(log_line, sizeof(log_line), "[%s] %s %s:%d: %s",
-        timestamp,
+    int written = snprintf(log_line, LOG_LINE_MAX, "[%s] %s %s:%d: %.*s",
+        timestamp_text,
         log_level_to_string(level),
         filename,
         line,
+        (int)length,
         message
     );
-    #pragma GCC diagnostic pop
+    if (written < 0) {
+        return -1;
+    }
+    return (written >= LOG_LINE_MAX) ? LOG_LINE_MAX - 1 : written;
+}
+
+static void batch_add(log_batch_t* batch, log_level_t level, const char* file, int line,
+                      time_t timestamp, const char* message, size_t length) {
+    if (batch->count == LOG_WRITE_BATCH) {
+        batch_flush(batch);
+    }
+    
+    int written = format_line(batch->lines[batch->count], cached_timestamp(timestamp), level, file, line,
+                              message, length);
+    if (written < 0) {
+        return;
+    }
+    
+    batch->lengths[batch->count] = (size_t)written;
+    batch->levels[batch->count] = level;
+    batch->count++;
+}
+
+static void batch_flush(log_batch_t* batch) {
+    write_lines(batch->lines, batch->lengths, batch->levels, batch->count);
+    batch->count = 0;
+}
+
+static void write_lines(char (*lines)[LOG_LINE_MAX], const size_t* lengths, const log_level_t* levels, int count) {
+    static char newline[] = "\n";
+    static char reset_newline[] = "\033[0m\n";
+    struct iovec iov[LOG_WRITE_BATCH * 3];
     
     // Write to console if enabled
     if (log_to_console) {
-        bool use_color = isatty(fileno(stderr));
-        if (use_color) {
-            fprintf(stderr, "%s%s\033[0m\n", log_level_to_color(level), log_line);
-        } else {
-            fprintf(stderr, "%s\n", log_line);
+        if (log_color < 0) {
+            log_color = isatty(STDERR_FILENO);
+        }
+        
+        int iov_count = 0;
+        for (int i = 0; i < count; i++) {
+            if (log_color) {
+                iov[iov_count].iov_base = (void*)log_level_to_color(levels[i]);
+                iov[iov_count++].iov_len = strlen(log_level_to_color(levels[i]));
+            }
+            iov[iov_count].iov_base = lines[i];
+            iov[iov_count++].iov_len = lengths[i];
+            iov[iov_count].iov_base = log_color ? reset_newline : newline;
+            iov[iov_count++].iov_len = log_color ? sizeof(reset_newline) - 1 : sizeof(newline) - 1;
         }
-        fflush(stderr);
+        write_iov(STDERR_FILENO, iov, iov_count);
     }
     
     // Write to log file
     if (log_file && log_file != stderr) {
-        fprintf(log_file, "%s\n", log_line);
-        fflush(log_file);
+        int iov_count = 0;
+        for (int i = 0; i < count; i++) {
+            iov[iov_count].iov_base = lines[i];
+            iov[iov_count++].iov_len = lengths[i];
+            iov[iov_count].iov_base = newline;
+            iov[iov_count++].iov_len = sizeof(newline) - 1;
+        }
+        write_iov(fileno(log_file), iov, iov_count);
     }
 }
+
+static void write_iov(int fd, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // Logging is best effort
+        }
+        
+        // Skip what was written, resume a partial write mid-vector
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
+    }
+}
+
+static int metric_bucket_index(uint64_t value) {
+    if (value < 2) {
+        return (int)value;
+    }
+    
+    // Log-linear: the highest bit selects the octave, the next one its half
+    int exponent = 63 - __builtin_clzll(value);
+    int index = 2 * exponent + (int)((value >> (exponent - 1)) & 1);
+    return index < METRIC_HISTOGRAM_BUCKETS ? index : METRIC_HISTOGRAM_BUCKETS - 1;
+}
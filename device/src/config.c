@@ -8,6 +8,7 @@
 #define _GNU_SOURCE  // Pour gethostname()
 #include "config.h"
 #include <limits.h>
+#include <sched.h>   // Pour CPU_SETSIZE
 #include <unistd.h>  // Pour gethostname()
 #include <string.h>  // Pour memcpy()
 
@@ -15,9 +16,15 @@
 static int parse_config_line(const char* line, const char* section, device_config_t* config);
 static int parse_device_section(const char* key, const char* value, device_config_t* config);
 static int parse_sensor_section(const char* key, const char* value, device_config_t* config);
+static int parse_sensor_entry(const char* key, const char* value, sensor_config_t* sensor);
+static int add_sensor(device_config_t* config, const char* id);
+static void add_implicit_sensor(device_config_t* config);
 static int parse_mqtt_section(const char* key, const char* value, device_config_t* config);
+static void parse_window_list(const char* value, device_config_t* config);
+static int parse_queue_section(const char* key, const char* value, device_config_t* config);
 static int parse_logging_section(const char* key, const char* value, device_config_t* config);
 static int parse_system_section(const char* key, const char* value, device_config_t* config);
+static int parse_emulator_section(const char* key, const char* value, device_config_t* config);
 static void trim_whitespace(char* str);
 static log_level_t parse_log_level(const char* level_str);
 
@@ -58,6 +65,7 @@ int config_load(const char* config_file, device_config_t* config) {
             file_path = DEFAULT_CONFIG_FILE;
         } else {
             LOG_WARN_F("No config file found, using defaults");
+            add_implicit_sensor(config);
             return TECHTEMP_OK;
         }
     }
@@ -84,6 +92,13 @@ int config_load(const char* config_file, device_config_t* config) {
             line[strlen(line)-1] = '\0'; // Remove closing bracket
             strncpy(current_section, line + 1, sizeof(current_section) - 1);
             current_section[sizeof(current_section) - 1] = '\0';
+            
+            // [sensor.<id>]: one more sensor, keys below apply to it
+            if (strncmp(current_section, "sensor.", 7) == 0 &&
+                add_sensor(config, current_section + 7) != TECHTEMP_OK) {
+                fclose(file);
+                return TECHTEMP_CONFIG_ERROR;
+            }
             continue;
         }
         
@@ -95,6 +110,7 @@ int config_load(const char* config_file, device_config_t* config) {
     }
     
     fclose(file);
+    add_implicit_sensor(config);
     LOG_INFO_F("Configuration loaded successfully");
     return TECHTEMP_OK;
 }
@@ -116,6 +132,13 @@ void config_set_defaults(device_config_t* config) {
     config->read_interval = 30;
     config->temp_offset = 0.0f;
     config->humidity_offset = 0.0f;
+    config->schedule_mode = SCHEDULE_FREE;
+    config->oversampling = 1;
+    config->oversampling_filter = OVERSAMPLING_MEDIAN;
+    config->deadband_temperature = 0.0f;
+    config->deadband_humidity = 0.0f;
+    config->heartbeat_seconds = 900;
+    config->sensor_count = 0;
     
     // MQTT defaults
     strncpy(config->mqtt_host, "localhost", sizeof(config->mqtt_host) - 1);
@@ -125,16 +148,55 @@ void config_set_defaults(device_config_t* config) {
     config->mqtt_qos = 1;
     config->mqtt_retain = false;
     config->mqtt_keepalive = 60;
+    config->mqtt_batch_size = 1;
+    config->mqtt_batch_max_latency_ms = 5000;
+    config->mqtt_payload_format = PAYLOAD_FORMAT_JSON;
+    config->mqtt_reconnect_delay = 5;
+    config->mqtt_reconnect_max_delay = 300;
+    config->mqtt_max_reconnect_attempts = 10;
+    config->aggregate_window_count = 0;
+    config->publish_raw = true;
+    config->stats_interval = 300;
+    
+    // Queue defaults
+    strncpy(config->queue_file, "/var/lib/techtemp/readings.queue", sizeof(config->queue_file) - 1);
+    config->queue_capacity = 8640;  // 3 days at 30 s
     
     // Logging defaults
     config->log_level = LOG_LEVEL_INFO;
     config->log_to_console = true;
     config->log_to_file = false;
     strncpy(config->log_file, "/var/log/techtemp-device.log", sizeof(config->log_file) - 1);
+    config->log_async = true;
+    config->log_block_when_full = false;
+    config->log_trace_file[0] = '\0';
+    config->log_trace_level = LOG_LEVEL_DEBUG;
+    config->log_trace_size_kb = 1024;
     
     // System defaults
     config->daemon_mode = false;
     strncpy(config->pid_file, "/var/run/techtemp-device.pid", sizeof(config->pid_file) - 1);
+    config->realtime = false;
+    config->realtime_cpu = -1;
+    config->realtime_priority = 50;
+    config->metrics_socket[0] = '\0';
+    config->metrics_port = 0;
+    
+    // Emulator defaults (no sensor in simulation builds)
+#ifdef SIMULATION_MODE
+    config->emulator_enabled = true;
+#else
+    config->emulator_enabled = false;
+#endif
+    config->emulator_conversion_ms = 80;
+    config->emulator_conversion_jitter_ms = 10;
+    config->emulator_bus_khz = 100;
+    config->emulator_nack_rate = 0.0f;
+    config->emulator_error_rate = 0.0f;
+    config->emulator_crc_error_rate = 0.0f;
+    config->emulator_brownout_rate = 0.0f;
+    config->emulator_period_seconds = 86400;
+    config->emulator_seed = 1;
 }
 
 /**
@@ -164,11 +226,85 @@ int config_validate(const device_config_t* config) {
         return TECHTEMP_CONFIG_ERROR;
     }
     
+    // Validate sensors
+    for (int i = 0; i < config->sensor_count; i++) {
+        const sensor_config_t* sensor = &config->sensors[i];
+        
+        if (sensor->id[0] == '\0' || strpbrk(sensor->id, "/+#") != NULL) {
+            LOG_ERROR_F("Invalid sensor id '%s' (empty or MQTT wildcard)", sensor->id);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        if (sensor->i2c_address < 0x03 || sensor->i2c_address > 0x77) {
+            LOG_ERROR_F("Invalid I2C address for sensor %s: 0x%02X (must be 0x03-0x77)",
+                        sensor->id, sensor->i2c_address);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        if (sensor->mux_address != 0 && (sensor->mux_address < 0x70 || sensor->mux_address > 0x77)) {
+            LOG_ERROR_F("Invalid multiplexer address for sensor %s: 0x%02X (must be 0x70-0x77)",
+                        sensor->id, sensor->mux_address);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        if (sensor->mux_channel < 0 || sensor->mux_channel > 7) {
+            LOG_ERROR_F("Invalid multiplexer channel for sensor %s: %d (must be 0-7)",
+                        sensor->id, sensor->mux_channel);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        for (int j = 0; j < i; j++) {
+            const sensor_config_t* other = &config->sensors[j];
+            if (strcmp(sensor->id, other->id) == 0) {
+                LOG_ERROR_F("Duplicate sensor id: %s", sensor->id);
+                return TECHTEMP_CONFIG_ERROR;
+            }
+            if (sensor->i2c_bus == other->i2c_bus && sensor->i2c_address == other->i2c_address &&
+                sensor->mux_address == other->mux_address &&
+                (sensor->mux_address == 0 || sensor->mux_channel == other->mux_channel)) {
+                LOG_ERROR_F("Sensors %s and %s share the same I2C path", other->id, sensor->id);
+                return TECHTEMP_CONFIG_ERROR;
+            }
+        }
+    }
+    
     if (config->read_interval <= 0 || config->read_interval > 3600) {
         LOG_ERROR_F("Invalid read interval: %d (must be 1-3600 seconds)", config->read_interval);
         return TECHTEMP_CONFIG_ERROR;
     }
     
+    if (config->oversampling < 1 || config->oversampling > MAX_OVERSAMPLING) {
+        LOG_ERROR_F("Invalid oversampling: %d (must be 1-%d)", config->oversampling, MAX_OVERSAMPLING);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->oversampling_filter == OVERSAMPLING_TRIMMED_MEAN && config->oversampling < 3) {
+        LOG_ERROR_F("Oversampling filter trimmed_mean needs at least 3 samples (oversampling = %d)",
+                    config->oversampling);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    // The sensor heats itself while converting: keep its activity low
+    if (config->oversampling > 1 &&
+        config->oversampling * OVERSAMPLING_ROUND_MS * 100 > config->read_interval * 1000 * OVERSAMPLING_MAX_DUTY) {
+        LOG_ERROR_F("Oversampling %d does not fit a %d s interval (%d ms per sample, %d%% of the interval max)",
+                    config->oversampling, config->read_interval, OVERSAMPLING_ROUND_MS, OVERSAMPLING_MAX_DUTY);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->deadband_temperature < 0.0f || config->deadband_humidity < 0.0f) {
+        LOG_ERROR_F("Invalid deadband: %.2f°C / %.2f%% (must be >= 0)",
+                    config->deadband_temperature, config->deadband_humidity);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if ((config->deadband_temperature > 0.0f || config->deadband_humidity > 0.0f) &&
+        (config->heartbeat_seconds < config->read_interval || config->heartbeat_seconds > 86400)) {
+        LOG_ERROR_F("Invalid heartbeat: %d (must be %d-86400 seconds)",
+                    config->heartbeat_seconds, config->read_interval);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
     // Validate MQTT settings
     if (strlen(config->mqtt_host) == 0) {
         LOG_ERROR_F("MQTT host cannot be empty");
@@ -180,6 +316,124 @@ int config_validate(const device_config_t* config) {
         return TECHTEMP_CONFIG_ERROR;
     }
     
+    if (config->mqtt_batch_size < 1 || config->mqtt_batch_size > 64) {
+        LOG_ERROR_F("Invalid MQTT batch size: %d (must be 1-64)", config->mqtt_batch_size);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->mqtt_batch_max_latency_ms <= 0) {
+        LOG_ERROR_F("Invalid MQTT batch latency: %d ms", config->mqtt_batch_max_latency_ms);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->mqtt_reconnect_delay < 1 || config->mqtt_reconnect_delay > 3600) {
+        LOG_ERROR_F("Invalid MQTT reconnect delay: %d (must be 1-3600 seconds)", config->mqtt_reconnect_delay);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->mqtt_reconnect_max_delay < config->mqtt_reconnect_delay || config->mqtt_reconnect_max_delay > 86400) {
+        LOG_ERROR_F("Invalid MQTT reconnect max delay: %d (must be %d-86400 seconds)",
+                    config->mqtt_reconnect_max_delay, config->mqtt_reconnect_delay);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->mqtt_max_reconnect_attempts < 0) {
+        LOG_ERROR_F("Invalid MQTT max reconnect attempts: %d", config->mqtt_max_reconnect_attempts);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->aggregate_window_count < 0) {
+        LOG_ERROR_F("Invalid aggregate windows (at most %d comma-separated durations in seconds)",
+                    MAX_AGGREGATE_WINDOWS);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    // Buckets aligned on the clock: a window must divide one day
+    for (int i = 0; i < config->aggregate_window_count; i++) {
+        int window = config->aggregate_windows[i];
+        if (window < config->read_interval || window > 86400 || 86400 % window != 0) {
+            LOG_ERROR_F("Invalid aggregate window: %d (must divide 86400 and be at least %d seconds)",
+                        window, config->read_interval);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+    }
+    
+    if (!config->publish_raw && config->aggregate_window_count == 0) {
+        LOG_ERROR_F("publish_raw = false requires aggregate_windows_seconds");
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->stats_interval != 0 &&
+        (config->stats_interval < MIN_STATS_INTERVAL || config->stats_interval > 86400)) {
+        LOG_ERROR_F("Invalid stats interval: %d (must be 0 or %d-86400 seconds)",
+                    config->stats_interval, MIN_STATS_INTERVAL);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->queue_capacity <= 0 || config->queue_capacity > 1000000) {
+        LOG_ERROR_F("Invalid queue capacity: %d (must be 1-1000000 readings)", config->queue_capacity);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->log_trace_file[0] != '\0' &&
+        (config->log_trace_size_kb < 16 || config->log_trace_size_kb > 65536)) {
+        LOG_ERROR_F("Invalid trace log size: %d KiB (must be 16-65536)", config->log_trace_size_kb);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    if (config->metrics_port < 0 || config->metrics_port > 65535) {
+        LOG_ERROR_F("Invalid metrics port: %d (must be 0-65535)", config->metrics_port);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    // Validate real-time settings
+    if (config->realtime) {
+        if (config->realtime_priority < 1 || config->realtime_priority > 99) {
+            LOG_ERROR_F("Invalid real-time priority: %d (must be 1-99)", config->realtime_priority);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        if (config->realtime_cpu < -1 || config->realtime_cpu >= CPU_SETSIZE) {
+            LOG_ERROR_F("Invalid real-time CPU: %d (must be -1-%d)", config->realtime_cpu, CPU_SETSIZE - 1);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        // The pacer samples on its own deadlines: no separate publish offset
+        if (config->schedule_mode == SCHEDULE_BOUNDARY) {
+            LOG_ERROR_F("Real-time mode requires schedule_mode free or spread");
+            return TECHTEMP_CONFIG_ERROR;
+        }
+    }
+    
+    // Validate emulator settings
+    if (config->emulator_enabled) {
+        if (config->emulator_conversion_ms < 1 || config->emulator_conversion_ms > 1000 ||
+            config->emulator_conversion_jitter_ms < 0 || config->emulator_conversion_jitter_ms > 1000) {
+            LOG_ERROR_F("Invalid emulator conversion time: %d ms + %d ms jitter (must be 1-1000 and 0-1000)",
+                        config->emulator_conversion_ms, config->emulator_conversion_jitter_ms);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        if (config->emulator_bus_khz < 0 || config->emulator_bus_khz > 3400) {
+            LOG_ERROR_F("Invalid emulator bus clock: %d kHz (must be 0-3400)", config->emulator_bus_khz);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+        
+        const float rates[] = { config->emulator_nack_rate, config->emulator_error_rate,
+                                config->emulator_crc_error_rate, config->emulator_brownout_rate };
+        for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+            if (rates[i] < 0.0f || rates[i] > 1.0f) {
+                LOG_ERROR_F("Invalid emulator fault rate: %.3f (must be 0-1)", rates[i]);
+                return TECHTEMP_CONFIG_ERROR;
+            }
+        }
+        
+        if (config->emulator_period_seconds < 1) {
+            LOG_ERROR_F("Invalid emulator period: %d seconds", config->emulator_period_seconds);
+            return TECHTEMP_CONFIG_ERROR;
+        }
+    }
+    
     return TECHTEMP_OK;
 }
 
@@ -196,7 +450,41 @@ void config_print(const device_config_t* config) {
     printf("I2C Address: 0x%02X\n", config->i2c_address);
     printf("I2C Bus: %d\n", config->i2c_bus);
     printf("Read Interval: %d seconds\n", config->read_interval);
+    if (config->oversampling > 1) {
+        printf("Oversampling: %d samples (%s)\n", config->oversampling,
+               config->oversampling_filter == OVERSAMPLING_MEDIAN ? "median" : "trimmed mean");
+    }
+    if (config->deadband_temperature > 0.0f || config->deadband_humidity > 0.0f) {
+        printf("Deadband: %.2f°C / %.2f%%, heartbeat %d seconds\n", config->deadband_temperature,
+               config->deadband_humidity, config->heartbeat_seconds);
+    }
+    for (int i = 0; i < config->sensor_count; i++) {
+        const sensor_config_t* sensor = &config->sensors[i];
+        if (sensor->mux_address != 0) {
+            printf("Sensor %s: bus %d, 0x%02X via mux 0x%02X channel %d\n", sensor->id, sensor->i2c_bus,
+                   sensor->i2c_address, sensor->mux_address, sensor->mux_channel);
+        } else {
+            printf("Sensor %s: bus %d, 0x%02X\n", sensor->id, sensor->i2c_bus, sensor->i2c_address);
+        }
+    }
     printf("MQTT Broker: %s:%d\n", config->mqtt_host, config->mqtt_port);
+    for (int i = 0; i < config->aggregate_window_count; i++) {
+        printf("Aggregate window: %d seconds\n", config->aggregate_windows[i]);
+    }
+    if (!config->publish_raw) {
+        printf("Raw readings: not published\n");
+    }
+    if (config->stats_interval > 0) {
+        printf("Stats: every %d seconds\n", config->stats_interval);
+    }
+    if (config->realtime) {
+        printf("Real-time: SCHED_FIFO priority %d, CPU %d\n", config->realtime_priority, config->realtime_cpu);
+    }
+    if (config->emulator_enabled) {
+        printf("Emulated sensors: %d ms conversion, faults NACK %.3f / error %.3f / CRC %.3f / brown-out %.3f\n",
+               config->emulator_conversion_ms, config->emulator_nack_rate, config->emulator_error_rate,
+               config->emulator_crc_error_rate, config->emulator_brownout_rate);
+    }
     printf("Log Level: %d\n", config->log_level);
     printf("=====================================\n\n");
 }
@@ -274,12 +562,18 @@ static int parse_config_line(const char* line, const char* section, device_confi
         return parse_device_section(key, value, config);
     } else if (strcmp(section, "sensor") == 0) {
         return parse_sensor_section(key, value, config);
+    } else if (strncmp(section, "sensor.", 7) == 0) {
+        return parse_sensor_entry(key, value, &config->sensors[config->sensor_count - 1]);
     } else if (strcmp(section, "mqtt") == 0) {
         return parse_mqtt_section(key, value, config);
+    } else if (strcmp(section, "queue") == 0) {
+        return parse_queue_section(key, value, config);
     } else if (strcmp(section, "logging") == 0) {
         return parse_logging_section(key, value, config);
     } else if (strcmp(section, "system") == 0) {
         return parse_system_section(key, value, config);
+    } else if (strcmp(section, "emulator") == 0) {
+        return parse_emulator_section(key, value, config);
     }
     
     return TECHTEMP_ERROR;
@@ -309,12 +603,83 @@ static int parse_sensor_section(const char* key, const char* value, device_confi
         config->temp_offset = (float)atof(value);
     } else if (strcmp(key, "humidity_offset") == 0) {
         config->humidity_offset = (float)atof(value);
+    } else if (strcmp(key, "schedule_mode") == 0) {
+        if (strcmp(value, "free") == 0) {
+            config->schedule_mode = SCHEDULE_FREE;
+        } else if (strcmp(value, "spread") == 0) {
+            config->schedule_mode = SCHEDULE_SPREAD;
+        } else if (strcmp(value, "boundary") == 0) {
+            config->schedule_mode = SCHEDULE_BOUNDARY;
+        } else {
+            return TECHTEMP_ERROR;  // Keeps the default (free)
+        }
+    } else if (strcmp(key, "oversampling") == 0) {
+        config->oversampling = atoi(value);
+    } else if (strcmp(key, "oversampling_filter") == 0) {
+        if (strcmp(value, "median") == 0) {
+            config->oversampling_filter = OVERSAMPLING_MEDIAN;
+        } else if (strcmp(value, "trimmed_mean") == 0) {
+            config->oversampling_filter = OVERSAMPLING_TRIMMED_MEAN;
+        } else {
+            return TECHTEMP_ERROR;  // Keeps the default (median)
+        }
+    } else if (strcmp(key, "deadband_temperature") == 0) {
+        config->deadband_temperature = (float)atof(value);
+    } else if (strcmp(key, "deadband_humidity") == 0) {
+        config->deadband_humidity = (float)atof(value);
+    } else if (strcmp(key, "heartbeat_seconds") == 0) {
+        config->heartbeat_seconds = atoi(value);
+    } else {
+        return TECHTEMP_ERROR;
+    }
+    return TECHTEMP_OK;
+}
+
+static int parse_sensor_entry(const char* key, const char* value, sensor_config_t* sensor) {
+    if (strcmp(key, "i2c_bus") == 0) {
+        sensor->i2c_bus = atoi(value);
+    } else if (strcmp(key, "i2c_address") == 0) {
+        sensor->i2c_address = (uint8_t)strtol(value, NULL, 0);
+    } else if (strcmp(key, "mux_address") == 0) {
+        sensor->mux_address = (uint8_t)strtol(value, NULL, 0);
+    } else if (strcmp(key, "mux_channel") == 0) {
+        sensor->mux_channel = atoi(value);
+    } else if (strcmp(key, "temperature_offset") == 0) {
+        sensor->temp_offset = (float)atof(value);
+    } else if (strcmp(key, "humidity_offset") == 0) {
+        sensor->humidity_offset = (float)atof(value);
     } else {
         return TECHTEMP_ERROR;
     }
     return TECHTEMP_OK;
 }
 
+static int add_sensor(device_config_t* config, const char* id) {
+    if (config->sensor_count >= MAX_SENSORS) {
+        LOG_ERROR_F("Too many sensors (max %d), cannot add %s", MAX_SENSORS, id);
+        return TECHTEMP_CONFIG_ERROR;
+    }
+    
+    // Bus and address default to the [sensor] settings read so far
+    sensor_config_t* sensor = &config->sensors[config->sensor_count++];
+    memset(sensor, 0, sizeof(*sensor));
+    safe_strcpy(sensor->id, id, sizeof(sensor->id));
+    sensor->i2c_bus = config->i2c_bus;
+    sensor->i2c_address = config->i2c_address;
+    return TECHTEMP_OK;
+}
+
+static void add_implicit_sensor(device_config_t* config) {
+    if (config->sensor_count > 0) {
+        return;
+    }
+    
+    // No [sensor.<id>] section: the single sensor of the [sensor] settings
+    add_sensor(config, config->device_uid);
+    config->sensors[0].temp_offset = config->temp_offset;
+    config->sensors[0].humidity_offset = config->humidity_offset;
+}
+
 static int parse_mqtt_section(const char* key, const char* value, device_config_t* config) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstringop-truncation"
@@ -333,6 +698,67 @@ static int parse_mqtt_section(const char* key, const char* value, device_config_
         config->mqtt_retain = (strcmp(value, "true") == 0);
     } else if (strcmp(key, "keepalive_seconds") == 0) {
         config->mqtt_keepalive = atoi(value);
+    } else if (strcmp(key, "batch_size") == 0) {
+        config->mqtt_batch_size = atoi(value);
+    } else if (strcmp(key, "batch_max_latency_ms") == 0) {
+        config->mqtt_batch_max_latency_ms = atoi(value);
+    } else if (strcmp(key, "reconnect_delay_seconds") == 0) {
+        config->mqtt_reconnect_delay = atoi(value);
+    } else if (strcmp(key, "reconnect_max_delay_seconds") == 0) {
+        config->mqtt_reconnect_max_delay = atoi(value);
+    } else if (strcmp(key, "max_reconnect_attempts") == 0) {
+        config->mqtt_max_reconnect_attempts = atoi(value);
+    } else if (strcmp(key, "aggregate_windows_seconds") == 0) {
+        parse_window_list(value, config);
+    } else if (strcmp(key, "publish_raw") == 0) {
+        config->publish_raw = (strcmp(value, "true") == 0);
+    } else if (strcmp(key, "stats_interval_seconds") == 0) {
+        config->stats_interval = atoi(value);
+    } else if (strcmp(key, "payload_format") == 0) {
+        if (strcmp(value, "json") == 0) {
+            config->mqtt_payload_format = PAYLOAD_FORMAT_JSON;
+        } else if (strcmp(value, "binary") == 0) {
+            config->mqtt_payload_format = PAYLOAD_FORMAT_BINARY;
+        } else {
+            return TECHTEMP_ERROR;  // Keeps the default (json)
+        }
+    } else {
+        return TECHTEMP_ERROR;
+    }
+    return TECHTEMP_OK;
+}
+
+static void parse_window_list(const char* value, device_config_t* config) {
+    // "60, 3600": comma-separated seconds, empty or 0 = disabled
+    config->aggregate_window_count = 0;
+    const char* cursor = value;
+    while (*cursor != '\0') {
+        char* end;
+        long window = strtol(cursor, &end, 10);
+        if (end == cursor) {
+            config->aggregate_window_count = -1;
+            return;
+        }
+        if (window != 0) {
+            if (config->aggregate_window_count == MAX_AGGREGATE_WINDOWS) {
+                config->aggregate_window_count = -1;
+                return;
+            }
+            config->aggregate_windows[config->aggregate_window_count++] = (int)window;
+        }
+        
+        cursor = end;
+        while (*cursor == ' ' || *cursor == '\t' || *cursor == ',') {
+            cursor++;
+        }
+    }
+}
+
+static int parse_queue_section(const char* key, const char* value, device_config_t* config) {
+    if (strcmp(key, "queue_file") == 0) {
+        safe_strcpy(config->queue_file, value, sizeof(config->queue_file));
+    } else if (strcmp(key, "queue_capacity") == 0) {
+        config->queue_capacity = atoi(value);
     } else {
         return TECHTEMP_ERROR;
     }
@@ -348,6 +774,22 @@ static int parse_logging_section(const char* key, const char* value, device_conf
         config->log_to_file = (strcmp(value, "true") == 0);
     } else if (strcmp(key, "log_file_path") == 0) {
         safe_strcpy(config->log_file, value, sizeof(config->log_file));
+    } else if (strcmp(key, "log_async") == 0) {
+        config->log_async = (strcmp(value, "true") == 0);
+    } else if (strcmp(key, "log_overflow") == 0) {
+        if (strcmp(value, "drop") == 0) {
+            config->log_block_when_full = false;
+        } else if (strcmp(value, "block") == 0) {
+            config->log_block_when_full = true;
+        } else {
+            return TECHTEMP_ERROR;  // Keeps the default (drop)
+        }
+    } else if (strcmp(key, "log_trace_file") == 0) {
+        safe_strcpy(config->log_trace_file, value, sizeof(config->log_trace_file));
+    } else if (strcmp(key, "log_trace_level") == 0) {
+        config->log_trace_level = parse_log_level(value);
+    } else if (strcmp(key, "log_trace_size_kb") == 0) {
+        config->log_trace_size_kb = atoi(value);
     } else {
         return TECHTEMP_ERROR;
     }
@@ -359,6 +801,43 @@ static int parse_system_section(const char* key, const char* value, device_confi
         config->daemon_mode = (strcmp(value, "true") == 0);
     } else if (strcmp(key, "pid_file") == 0) {
         safe_strcpy(config->pid_file, value, sizeof(config->pid_file));
+    } else if (strcmp(key, "realtime") == 0) {
+        config->realtime = (strcmp(value, "true") == 0);
+    } else if (strcmp(key, "realtime_cpu") == 0) {
+        config->realtime_cpu = atoi(value);
+    } else if (strcmp(key, "realtime_priority") == 0) {
+        config->realtime_priority = atoi(value);
+    } else if (strcmp(key, "metrics_socket") == 0) {
+        safe_strcpy(config->metrics_socket, value, sizeof(config->metrics_socket));
+    } else if (strcmp(key, "metrics_port") == 0) {
+        config->metrics_port = atoi(value);
+    } else {
+        return TECHTEMP_ERROR;
+    }
+    return TECHTEMP_OK;
+}
+
+static int parse_emulator_section(const char* key, const char* value, device_config_t* config) {
+    if (strcmp(key, "enabled") == 0) {
+        config->emulator_enabled = (strcmp(value, "true") == 0);
+    } else if (strcmp(key, "conversion_ms") == 0) {
+        config->emulator_conversion_ms = atoi(value);
+    } else if (strcmp(key, "conversion_jitter_ms") == 0) {
+        config->emulator_conversion_jitter_ms = atoi(value);
+    } else if (strcmp(key, "bus_khz") == 0) {
+        config->emulator_bus_khz = atoi(value);
+    } else if (strcmp(key, "nack_rate") == 0) {
+        config->emulator_nack_rate = atof(value);
+    } else if (strcmp(key, "error_rate") == 0) {
+        config->emulator_error_rate = atof(value);
+    } else if (strcmp(key, "crc_error_rate") == 0) {
+        config->emulator_crc_error_rate = atof(value);
+    } else if (strcmp(key, "brownout_rate") == 0) {
+        config->emulator_brownout_rate = atof(value);
+    } else if (strcmp(key, "period_seconds") == 0) {
+        config->emulator_period_seconds = atoi(value);
+    } else if (strcmp(key, "seed") == 0) {
+        config->emulator_seed = (uint32_t)strtoul(value, NULL, 10);
     } else {
         return TECHTEMP_ERROR;
     }
@@ -0,0 +1,229 @@
+/**
+ * @file event_loop.c
+ * @brief Single-threaded epoll reactor implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#define _DEFAULT_SOURCE  // Pour CLOCK_MONOTONIC
+#include "event_loop.h"
+#include <sys/timerfd.h>
+
+// Watched descriptor
+typedef struct {
+    int fd;
+    event_handler_t handler;
+    void* ctx;
+} event_watch_t;
+
+// Internal state
+static int epoll_fd = -1;
+static event_watch_t watches[EVENT_LOOP_MAX_WATCHES];
+static metric_t* wakeup_metric = NULL;
+
+// Internal helper functions
+static event_watch_t* find_watch(int fd);
+
+/**
+ * Initialize the event loop
+ */
+int event_loop_init(void) {
+    if (epoll_fd != -1) {
+        return TECHTEMP_OK;
+    }
+    
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        LOG_ERROR_F("Failed to create epoll instance: %s", strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    for (int i = 0; i < EVENT_LOOP_MAX_WATCHES; i++) {
+        watches[i].fd = -1;
+    }
+    wakeup_metric = metric_register("techtemp_event_loop_wakeups_total",
+                                    "epoll_wait returns of the event loop", METRIC_COUNTER);
+    
+    return TECHTEMP_OK;
+}
+
+/**
+ * Watch a file descriptor
+ */
+int event_loop_add(int fd, uint32_t events, event_handler_t handler, void* ctx) {
+    if (epoll_fd < 0 || fd < 0 || !handler) {
+        return TECHTEMP_ERROR;
+    }
+    
+    event_watch_t* watch = find_watch(-1);
+    if (!watch) {
+        LOG_ERROR_F("Event loop full (%d watches)", EVENT_LOOP_MAX_WATCHES);
+        return TECHTEMP_ERROR;
+    }
+    
+    struct epoll_event ev = { .events = events, .data.ptr = watch };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        LOG_ERROR_F("Failed to watch fd %d: %s", fd, strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    watch->fd = fd;
+    watch->handler = handler;
+    watch->ctx = ctx;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Change the events of interest for a watched file descriptor
+ */
+int event_loop_modify(int fd, uint32_t events) {
+    event_watch_t* watch = find_watch(fd);
+    if (epoll_fd < 0 || fd < 0 || !watch) {
+        return TECHTEMP_ERROR;
+    }
+    
+    struct epoll_event ev = { .events = events, .data.ptr = watch };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) != 0) {
+        LOG_ERROR_F("Failed to modify watch on fd %d: %s", fd, strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    return TECHTEMP_OK;
+}
+
+/**
+ * Stop watching a file descriptor
+ */
+int event_loop_remove(int fd) {
+    event_watch_t* watch = find_watch(fd);
+    if (epoll_fd < 0 || fd < 0 || !watch) {
+        return TECHTEMP_ERROR;
+    }
+    
+    // The descriptor may already be closed (epoll dropped it): ignore errors
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    
+    watch->fd = -1;
+    watch->handler = NULL;
+    watch->ctx = NULL;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Wait for events and dispatch them
+ */
+int event_loop_run_once(int timeout_ms) {
+    if (epoll_fd < 0) {
+        return TECHTEMP_ERROR;
+    }
+    
+    struct epoll_event events[EVENT_LOOP_MAX_WATCHES];
+    int count = epoll_wait(epoll_fd, events, EVENT_LOOP_MAX_WATCHES, timeout_ms);
+    if (count < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        LOG_ERROR_F("epoll_wait failed: %s", strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    metric_inc(wakeup_metric);
+    
+    for (int i = 0; i < count; i++) {
+        event_watch_t* watch = events[i].data.ptr;
+        
+        // Watch removed by a previous handler in this batch
+        if (watch->fd < 0) {
+            continue;
+        }
+        
+        watch->handler(watch->fd, events[i].events, watch->ctx);
+    }
+    
+    return count;
+}
+
+/**
+ * Release the event loop resources
+ */
+void event_loop_cleanup(void) {
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+    
+    for (int i = 0; i < EVENT_LOOP_MAX_WATCHES; i++) {
+        watches[i].fd = -1;
+    }
+}
+
+/**
+ * Create a non-blocking monotonic timer
+ */
+int timer_fd_create(void) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR_F("Failed to create timer: %s", strerror(errno));
+    }
+    return fd;
+}
+
+/**
+ * Arm a timer file descriptor
+ */
+int timer_fd_arm_ms(int fd, uint64_t initial_ms, uint64_t interval_ms) {
+    struct itimerspec spec = {
+        .it_interval = { (time_t)(interval_ms / 1000), (long)(interval_ms % 1000) * 1000000L },
+        .it_value = { (time_t)(initial_ms / 1000), (long)(initial_ms % 1000) * 1000000L }
+    };
+    
+    if (timerfd_settime(fd, 0, &spec, NULL) != 0) {
+        LOG_ERROR_F("Failed to arm timer fd %d: %s", fd, strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    return TECHTEMP_OK;
+}
+
+/**
+ * Arm a one-shot timer at an absolute monotonic time
+ */
+int timer_fd_arm_abs_ms(int fd, uint64_t deadline_ms) {
+    // A zero it_value would disarm the timer
+    if (deadline_ms == 0) {
+        deadline_ms = 1;
+    }
+    
+    struct itimerspec spec = {
+        .it_interval = { 0, 0 },
+        .it_value = { (time_t)(deadline_ms / 1000), (long)(deadline_ms % 1000) * 1000000L }
+    };
+    
+    if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, NULL) != 0) {
+        LOG_ERROR_F("Failed to arm timer fd %d: %s", fd, strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    return TECHTEMP_OK;
+}
+
+/**
+ * Consume pending timer expirations
+ */
+uint64_t timer_fd_consume(int fd) {
+    uint64_t expirations = 0;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return 0;
+    }
+    return expirations;
+}
+
+// Internal helper functions
+
+static event_watch_t* find_watch(int fd) {
+    for (int i = 0; i < EVENT_LOOP_MAX_WATCHES; i++) {
+        if (watches[i].fd == fd) {
+            return &watches[i];
+        }
+    }
+    return NULL;
+}
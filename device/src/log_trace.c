@@ -0,0 +1,480 @@
+/**
+ * @file log_trace.c
+ * @brief Binary trace log implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * The mapping is MAP_SHARED and never msync'd per record: the kernel
+ * writes dirty pages back in the background, so a crash of the process
+ * keeps everything and a power loss only the last writeback interval.
+ */
+
+#define _GNU_SOURCE  // Pour MAP_ANONYMOUS et clock_gettime()
+#include "log_trace.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SITE_LOOKUP_SLOTS  (2 * LOG_TRACE_MAX_SITES)  // Power of two
+#define SITE_NONE          0xFFFD                     // In memory: call site not traceable
+
+// Call-site cache: format address + line → site id (per process)
+typedef struct {
+    const char* format;
+    int line;
+    uint16_t site;
+} site_lookup_t;
+
+int log_trace_threshold = INT_MAX;
+
+// Internal state
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int trace_fd = -1;
+static uint8_t* mapping = NULL;
+static size_t mapping_size = 0;
+static log_trace_header_t* header = NULL;
+static log_trace_site_t* sites = NULL;
+static uint8_t* ring = NULL;
+static site_lookup_t site_lookup[SITE_LOOKUP_SLOTS];
+
+// Internal helper functions
+static void init_header(uint64_t data_size);
+static bool header_consistent(uint64_t data_size);
+static uint16_t find_site(log_level_t level, const char* file, int line, const char* format);
+static uint16_t register_site(log_level_t level, const char* file, int line, const char* format);
+static bool format_traceable(const char* format);
+static size_t encode_arguments(uint8_t* buffer, size_t size, const char* format, va_list args);
+static void append_record(uint16_t site, uint64_t timestamp_ns, const uint8_t* payload, size_t payload_length);
+static void make_room(uint64_t length);
+static uint64_t monotonic_ns(void);
+static void put_u16(uint8_t* buffer, uint16_t value);
+static void put_u64(uint8_t* buffer, uint64_t value);
+
+/**
+ * Open (or create) the trace file and start tracing
+ */
+int log_trace_open(const char* path, int size_kb, log_level_t level) {
+    if (mapping || !path || path[0] == '\0' || size_kb <= 0) {
+        return TECHTEMP_ERROR;
+    }
+    
+    uint64_t data_size = (uint64_t)size_kb * 1024;
+    mapping_size = sizeof(log_trace_header_t) + LOG_TRACE_MAX_SITES * sizeof(log_trace_site_t) + data_size;
+    
+    trace_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (trace_fd < 0) {
+        LOG_ERROR_F("Failed to open trace log %s: %s", path, strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    struct stat st = {0};
+    bool existing = (fstat(trace_fd, &st) == 0 && (size_t)st.st_size == mapping_size);
+    
+    if (!existing && ftruncate(trace_fd, (off_t)mapping_size) != 0) {
+        LOG_ERROR_F("Failed to size trace log %s: %s", path, strerror(errno));
+        close(trace_fd);
+        trace_fd = -1;
+        return TECHTEMP_ERROR;
+    }
+    
+    mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, trace_fd, 0);
+    if (mapping == MAP_FAILED) {
+        mapping = NULL;
+        LOG_ERROR_F("Failed to map trace log %s: %s", path, strerror(errno));
+        close(trace_fd);
+        trace_fd = -1;
+        return TECHTEMP_ERROR;
+    }
+    
+    header = (log_trace_header_t*)mapping;
+    sites = (log_trace_site_t*)(mapping + sizeof(log_trace_header_t));
+    ring = mapping + sizeof(log_trace_header_t) + LOG_TRACE_MAX_SITES * sizeof(log_trace_site_t);
+    
+    if (existing && header_consistent(data_size)) {
+        // Keep the previous run for post-mortems; its call sites stay valid
+        LOG_INFO_F("Trace log %s reopened: %llu bytes of records, %u call sites",
+                   path, (unsigned long long)header->used, header->site_count);
+    } else {
+        init_header(data_size);
+        LOG_INFO_F("Trace log %s created (%d KiB)", path, size_kb);
+    }
+    
+    for (int i = 0; i < SITE_LOOKUP_SLOTS; i++) {
+        site_lookup[i].format = NULL;
+    }
+    
+    // Clock reference for this run: monotonic timestamps → wall clock
+    uint8_t epoch[8];
+    put_u64(epoch, get_timestamp_ms());
+    append_record(LOG_TRACE_SITE_EPOCH, monotonic_ns(), epoch, sizeof(epoch));
+    
+    __atomic_store_n(&log_trace_threshold, (int)level, __ATOMIC_RELEASE);
+    return TECHTEMP_OK;
+}
+
+/**
+ * Record one log call
+ */
+void log_trace_record(log_level_t level, const char* file, int line, const char* format, va_list args) {
+    uint64_t timestamp_ns = monotonic_ns();
+    uint8_t payload[LOG_TRACE_RECORD_MAX - LOG_TRACE_RECORD_HEADER];
+    
+    pthread_mutex_lock(&trace_mutex);
+    
+    if (!header) {
+        pthread_mutex_unlock(&trace_mutex);
+        return;
+    }
+    
+    uint16_t site = find_site(level, file, line, format);
+    size_t length = (site == SITE_NONE) ? SIZE_MAX : encode_arguments(payload, sizeof(payload), format, args);
+    
+    if (length == SIZE_MAX) {
+        header->dropped++;
+    } else {
+        append_record(site, timestamp_ns, payload, length);
+    }
+    
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+/**
+ * Find the next conversion specification in a printf format
+ */
+const char* log_trace_next_conversion(const char* format, log_trace_conversion_t* conversion) {
+    const char* p = strchr(format, '%');
+    if (!p) {
+        return NULL;
+    }
+    
+    conversion->start = p++;
+    conversion->stars = 0;
+    
+    // Flags, width, precision
+    while (*p && strchr("-+ #0'", *p)) p++;
+    if (*p == '*') {
+        conversion->stars++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            conversion->stars++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    
+    // Length modifier
+    int longs = 0;
+    char modifier = '\0';
+    if (*p == 'h') {
+        p += (p[1] == 'h') ? 2 : 1;
+    } else if (*p == 'l') {
+        longs = (p[1] == 'l') ? 2 : 1;
+        p += longs;
+    } else if (*p == 'L' || *p == 'z' || *p == 'j' || *p == 't') {
+        modifier = *p++;
+    }
+    
+    bool is_signed = true;
+    switch (*p) {
+        case 'u': case 'o': case 'x': case 'X':
+            is_signed = false;
+            // fall through
+        case 'd': case 'i':
+            if (modifier == 'z') {
+                conversion->kind = LOG_ARG_SIZE;
+            } else if (modifier == 'j') {
+                conversion->kind = LOG_ARG_INTMAX;
+            } else if (modifier == 't') {
+                conversion->kind = LOG_ARG_PTRDIFF;
+            } else if (longs == 2) {
+                conversion->kind = is_signed ? LOG_ARG_LLONG : LOG_ARG_ULLONG;
+            } else if (longs == 1) {
+                conversion->kind = is_signed ? LOG_ARG_LONG : LOG_ARG_ULONG;
+            } else {
+                conversion->kind = is_signed ? LOG_ARG_INT : LOG_ARG_UINT;
+            }
+            break;
+        case 'c':
+            conversion->kind = (longs == 0) ? LOG_ARG_INT : LOG_ARG_INVALID;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            conversion->kind = (modifier == 'L') ? LOG_ARG_LONG_DOUBLE : LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            conversion->kind = (longs == 0) ? LOG_ARG_STRING : LOG_ARG_INVALID;
+            break;
+        case 'p':
+            conversion->kind = LOG_ARG_POINTER;
+            break;
+        case '%':
+            conversion->kind = LOG_ARG_NONE;
+            break;
+        default:
+            conversion->kind = LOG_ARG_INVALID;  // %n, wide strings, truncated format
+            break;
+    }
+    
+    if (*p) {
+        p++;
+    }
+    conversion->length = (size_t)(p - conversion->start);
+    return p;
+}
+
+/**
+ * Stop tracing, flush and close the trace file
+ */
+void log_trace_close(void) {
+    __atomic_store_n(&log_trace_threshold, INT_MAX, __ATOMIC_RELEASE);
+    
+    pthread_mutex_lock(&trace_mutex);
+    if (mapping) {
+        msync(mapping, mapping_size, MS_SYNC);
+        munmap(mapping, mapping_size);
+        mapping = NULL;
+    }
+    if (trace_fd != -1) {
+        close(trace_fd);
+        trace_fd = -1;
+    }
+    header = NULL;
+    sites = NULL;
+    ring = NULL;
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+// Internal helper functions
+
+static void init_header(uint64_t data_size) {
+    memset(header, 0, sizeof(*header));
+    header->magic = LOG_TRACE_MAGIC;
+    header->version = LOG_TRACE_VERSION;
+    header->max_sites = LOG_TRACE_MAX_SITES;
+    header->data_size = data_size;
+}
+
+static bool header_consistent(uint64_t data_size) {
+    return header->magic == LOG_TRACE_MAGIC &&
+           header->version == LOG_TRACE_VERSION &&
+           header->max_sites == LOG_TRACE_MAX_SITES &&
+           header->site_count <= LOG_TRACE_MAX_SITES &&
+           header->data_size == data_size &&
+           header->head < data_size &&
+           header->tail < data_size &&
+           header->used <= data_size;
+}
+
+static uint16_t find_site(log_level_t level, const char* file, int line, const char* format) {
+    // Identical literals may be merged by the linker: the line disambiguates
+    uintptr_t key = (uintptr_t)format ^ ((uintptr_t)line * 2654435761u);
+    uint32_t slot = (uint32_t)(key ^ (key >> 17)) & (SITE_LOOKUP_SLOTS - 1);
+    
+    for (int probe = 0; probe < SITE_LOOKUP_SLOTS; probe++) {
+        site_lookup_t* entry = &site_lookup[slot];
+        if (entry->format == format && entry->line == line) {
+            return entry->site;
+        }
+        if (entry->format == NULL) {
+            entry->format = format;
+            entry->line = line;
+            entry->site = register_site(level, file, line, format);
+            return entry->site;
+        }
+        slot = (slot + 1) & (SITE_LOOKUP_SLOTS - 1);
+    }
+    
+    return SITE_NONE;
+}
+
+static uint16_t register_site(log_level_t level, const char* file, int line, const char* format) {
+    if (strlen(format) >= LOG_TRACE_FORMAT_MAX || !format_traceable(format)) {
+        return SITE_NONE;
+    }
+    
+    const char* filename = strrchr(file, '/');
+    filename = filename ? filename + 1 : file;
+    
+    // Same binary as the previous run: reuse its site ids
+    for (uint32_t i = 0; i < header->site_count; i++) {
+        const log_trace_site_t* site = &sites[i];
+        if (site->line == (uint32_t)line && site->level == (uint8_t)level &&
+            strncmp(site->file, filename, sizeof(site->file)) == 0 &&
+            strcmp(site->format, format) == 0) {
+            return (uint16_t)i;
+        }
+    }
+    
+    if (header->site_count >= LOG_TRACE_MAX_SITES) {
+        return SITE_NONE;
+    }
+    
+    log_trace_site_t* site = &sites[header->site_count];
+    memset(site, 0, sizeof(*site));
+    site->line = (uint32_t)line;
+    site->level = (uint8_t)level;
+    snprintf(site->file, sizeof(site->file), "%s", filename);
+    snprintf(site->format, sizeof(site->format), "%s", format);
+    return (uint16_t)header->site_count++;
+}
+
+static bool format_traceable(const char* format) {
+    log_trace_conversion_t conversion;
+    while ((format = log_trace_next_conversion(format, &conversion)) != NULL) {
+        if (conversion.kind == LOG_ARG_INVALID) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t encode_arguments(uint8_t* buffer, size_t size, const char* format, va_list args) {
+    log_trace_conversion_t conversion;
+    size_t length = 0;
+    
+    while ((format = log_trace_next_conversion(format, &conversion)) != NULL) {
+        if (conversion.kind == LOG_ARG_NONE) {
+            continue;
+        }
+        
+        // Worst case for this conversion: stars + one 8-byte value or a string
+        if (length + 8 * (size_t)(conversion.stars + 1) > size) {
+            return SIZE_MAX;
+        }
+        for (int i = 0; i < conversion.stars; i++) {
+            put_u64(buffer + length, (uint64_t)(int64_t)va_arg(args, int));
+            length += 8;
+        }
+        
+        uint64_t value = 0;
+        switch (conversion.kind) {
+            case LOG_ARG_INT:         value = (uint64_t)(int64_t)va_arg(args, int); break;
+            case LOG_ARG_UINT:        value = va_arg(args, unsigned int); break;
+            case LOG_ARG_LONG:        value = (uint64_t)(int64_t)va_arg(args, long); break;
+            case LOG_ARG_ULONG:       value = va_arg(args, unsigned long); break;
+            case LOG_ARG_LLONG:       value = (uint64_t)va_arg(args, long long); break;
+            case LOG_ARG_ULLONG:      value = va_arg(args, unsigned long long); break;
+            case LOG_ARG_SIZE:        value = va_arg(args, size_t); break;
+            case LOG_ARG_INTMAX:      value = (uint64_t)va_arg(args, intmax_t); break;
+            case LOG_ARG_PTRDIFF:     value = (uint64_t)(int64_t)va_arg(args, ptrdiff_t); break;
+            case LOG_ARG_POINTER:     value = (uint64_t)(uintptr_t)va_arg(args, void*); break;
+            case LOG_ARG_DOUBLE:
+            case LOG_ARG_LONG_DOUBLE: {
+                double number = (conversion.kind == LOG_ARG_DOUBLE) ?
+                                va_arg(args, double) : (double)va_arg(args, long double);
+                memcpy(&value, &number, sizeof(value));
+                break;
+            }
+            case LOG_ARG_STRING: {
+                const char* text = va_arg(args, const char*);
+                if (!text) {
+                    text = "(null)";
+                }
+                size_t text_length = strnlen(text, LOG_TRACE_STRING_MAX);
+                if (length + 1 + text_length > size) {
+                    text_length = size - length - 1;
+                }
+                buffer[length++] = (uint8_t)text_length;
+                memcpy(buffer + length, text, text_length);
+                length += text_length;
+                continue;
+            }
+            default:
+                return SIZE_MAX;
+        }
+        
+        put_u64(buffer + length, value);
+        length += 8;
+    }
+    
+    return length;
+}
+
+static void append_record(uint16_t site, uint64_t timestamp_ns, const uint8_t* payload, size_t payload_length) {
+    uint64_t length = LOG_TRACE_RECORD_HEADER + payload_length;
+    
+    // Records never wrap: skip the end of the ring when it is too short
+    uint64_t remaining = header->data_size - header->head;
+    if (remaining < length) {
+        make_room(remaining);
+        if (remaining >= LOG_TRACE_RECORD_HEADER) {
+            put_u16(ring + header->head, LOG_TRACE_SITE_PADDING);
+            put_u16(ring + header->head + 2, 0);
+        }
+        header->used += remaining;
+        header->head = 0;
+    }
+    
+    make_room(length);
+    
+    uint8_t* record = ring + header->head;
+    put_u16(record, site);
+    put_u16(record + 2, (uint16_t)length);
+    put_u64(record + 4, timestamp_ns);
+    memcpy(record + LOG_TRACE_RECORD_HEADER, payload, payload_length);
+    
+    // Record first, then the header fields that make it visible
+    header->head += length;
+    if (header->head == header->data_size) {
+        header->head = 0;
+    }
+    header->used += length;
+}
+
+static void make_room(uint64_t length) {
+    // Evict the oldest records until `length` contiguous bytes follow head
+    while (header->data_size - header->used < length) {
+        uint64_t remaining = header->data_size - header->tail;
+        uint64_t freed = remaining;
+        
+        if (remaining >= LOG_TRACE_RECORD_HEADER) {
+            const uint8_t* record = ring + header->tail;
+            uint16_t site = (uint16_t)(record[0] | (record[1] << 8));
+            if (site != LOG_TRACE_SITE_PADDING) {
+                freed = (uint16_t)(record[2] | (record[3] << 8));
+            }
+            if (site == LOG_TRACE_SITE_EPOCH && freed == LOG_TRACE_RECORD_HEADER + 8) {
+                // Keep the clock reference of the records that follow it
+                memcpy(&header->epoch_monotonic_ns, record + 4, 8);
+                memcpy(&header->epoch_realtime_ms, record + LOG_TRACE_RECORD_HEADER, 8);
+            }
+        }
+        
+        if (freed == 0 || freed > header->used) {
+            // Corrupted record (torn write): restart the ring from head
+            header->tail = header->head;
+            header->used = 0;
+            break;
+        }
+        
+        header->tail += freed;
+        if (header->tail >= header->data_size) {
+            header->tail = 0;
+        }
+        header->used -= freed;
+    }
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void put_u16(uint8_t* buffer, uint16_t value) {
+    buffer[0] = (uint8_t)(value & 0xFF);
+    buffer[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u64(uint8_t* buffer, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+}
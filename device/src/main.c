@@ -8,23 +8,661 @@
  * Reads temperature/humidity and publishes to MQTT broker
  */
 
-#define _DEFAULT_SOURCE  // Pour usleep()
+#define _DEFAULT_SOURCE  // Pour sigprocmask()
 #include "common.h"
 #include "config.h"
-#include "aht20.h"
+#include "sensor_registry.h"
+#include "acquisition.h"
 #include "mqtt_client.h"
-#include <unistd.h>  // Pour usleep()
+#include "event_loop.h"
+#include "schedule.h"
+#include "log_trace.h"
+#include "metrics_server.h"
+#include "aht20_emulator.h"
+#include "probes.h"
+#include <sys/signalfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <fcntl.h>
 
 // Global variables
 volatile bool g_running = true;
 device_config_t g_config;
 
+// MQTT connection manager
+#define MQTT_CONNECT_TIMEOUT_MS  5000
+#define MQTT_BACKOFF_MAX_SHIFT   20     // Keeps base << attempt from overflowing
+
+// Event loop state
+static int mqtt_watch_fd = -1;
+static uint32_t mqtt_watch_events = 0;
+static bool mqtt_was_connected = false;
+static int reconnect_timer = -1;
+static int reconnect_attempt = 0;          // Consecutive failed attempts
+static bool connect_pending = false;       // Attempt started, outcome unknown
+static uint32_t jitter_state = 0;
+static int sample_timer = -1;
+static int publish_timer = -1;
+static uint32_t phase_offset_ms = 0;       // Per-device offset within the interval
+static uint64_t slot_deadline_ms = 0;      // Monotonic deadline of the next sample
+static uint64_t sample_slot_ms = 0;        // Monotonic deadline of the last sample
+static bool publish_held = false;          // Boundary mode: wait for the device offset
+static bool draining = false;
+static int batch_timer = -1;
+static bool batch_timer_armed = false;
+static bool flush_pending = false;
+static sensor_t* publishing_sensor = NULL; // Queue being drained (early QoS 0 acks)
+static aggregate_window_t* publishing_window = NULL;  // Aggregates being published (early QoS 0 acks)
+static bool ever_connected = false;
+static metric_t* reconnect_metric = NULL;
+static metric_t* connect_failure_metric = NULL;
+static metric_t* readings_metric = NULL;
+static int stats_timer = -1;
+static char stats_topic[MAX_TOPIC_LEN];
+static uint64_t start_ms = 0;              // Monotonic start time (uptime)
+
+/**
+ * Get the number of readings not yet published, all sensors
+ */
+static uint32_t total_unsent(void) {
+    uint32_t unsent = 0;
+    for (int i = 0; i < sensor_registry_count(); i++) {
+        unsent += reading_queue_unsent(&sensor_registry_get(i)->queue);
+    }
+    return unsent;
+}
+
+/**
+ * Get the number of readings not yet acknowledged, all sensors
+ */
+static uint32_t total_depth(void) {
+    uint32_t depth = 0;
+    for (int i = 0; i < sensor_registry_count(); i++) {
+        depth += reading_queue_depth(&sensor_registry_get(i)->queue);
+    }
+    return depth;
+}
+
+/**
+ * Publish the closed aggregation buckets of a sensor, oldest first
+ * (retired on PUBACK, published again after a reconnection otherwise)
+ */
+static void publish_aggregates(sensor_t* sensor) {
+    for (int w = 0; w < sensor->aggregate_count; w++) {
+        aggregate_window_t* window = &sensor->aggregates[w];
+        const aggregate_bucket_t* bucket;
+        while (mqtt_is_connected() && (bucket = aggregate_peek_unsent(window)) != NULL) {
+            int mid;
+            publishing_window = window;
+            int result = mqtt_publish_aggregate(bucket, sensor->aggregate_topic, &mid);
+            publishing_window = NULL;
+            if (result != TECHTEMP_OK) {
+                LOG_WARN_F("⚠️  Failed to publish aggregate for %s: %s", sensor->id, mqtt_get_error());
+                return;
+            }
+            aggregate_mark_sent(window, mid);
+        }
+    }
+}
+
+/**
+ * Publish queued readings in order, within the in-flight window
+ * (each sensor queue in turn, on its own topic, then its aggregates)
+ * In batch mode only full batches are sent unless a flush was requested
+ * (max latency expired or backlog after reconnection)
+ */
+static void drain_queue(bool flush) {
+    sensor_reading_t batch[MQTT_BATCH_MAX_READINGS];
+    int batch_size = g_config.mqtt_batch_size;
+    
+    // Re-entrant call from the publish callback: the outer loop continues.
+    // Boundary schedule: nothing leaves before this device's publish offset
+    if (draining || publish_held) {
+        return;
+    }
+    draining = true;
+    flush_pending = flush_pending || flush;
+    
+    for (int i = 0; i < sensor_registry_count() && mqtt_is_connected(); i++) {
+        sensor_t* sensor = sensor_registry_get(i);
+        publishing_sensor = sensor;
+        
+        while (mqtt_is_connected()) {
+            if (batch_size > 1 && !flush_pending && reading_queue_unsent(&sensor->queue) < (uint32_t)batch_size) {
+                break;
+            }
+            
+            int count = reading_queue_peek_unsent(&sensor->queue, batch, batch_size);
+            if (count == 0) {
+                break;
+            }
+            
+            int mid;
+            int result = (batch_size > 1)
+                ? mqtt_publish_batch(batch, count, sensor->batch_topic, &mid)
+                : mqtt_publish_reading(&batch[0], sensor->topic, &mid);
+            if (result != TECHTEMP_OK) {
+                LOG_WARN_F("⚠️  Failed to publish data for %s: %s", sensor->id, mqtt_get_error());
+                break;
+            }
+            reading_queue_mark_sent(&sensor->queue, mid, count);
+        }
+        
+        publishing_sensor = NULL;
+        publish_aggregates(sensor);
+    }
+    publishing_sensor = NULL;
+    
+    uint32_t unsent = total_unsent();
+    if (unsent == 0) {
+        flush_pending = false;
+    }
+    
+    // Bound the latency of a partial batch
+    if (batch_timer >= 0) {
+        if (unsent > 0 && mqtt_is_connected() && !batch_timer_armed) {
+            batch_timer_armed = (timer_fd_arm_ms(batch_timer, (uint64_t)g_config.mqtt_batch_max_latency_ms, 0) == TECHTEMP_OK);
+        } else if (unsent == 0 && batch_timer_armed) {
+            timer_fd_arm_ms(batch_timer, 0, 0);
+            batch_timer_armed = false;
+        }
+    }
+    
+    draining = false;
+}
+
+/**
+ * Broker acknowledged a reading or an aggregate: retire it and send the next ones
+ */
+static void on_reading_acked(int mid) {
+    bool found = false;
+    for (int i = 0; i < sensor_registry_count() && !found; i++) {
+        sensor_t* sensor = sensor_registry_get(i);
+        found = reading_queue_ack(&sensor->queue, mid);
+        for (int w = 0; w < sensor->aggregate_count && !found; w++) {
+            found = aggregate_ack(&sensor->aggregates[w], mid);
+        }
+    }
+    
+    // QoS 0: acknowledged from inside the publish call, before mark_sent
+    if (!found && publishing_window) {
+        aggregate_ack_unsent(publishing_window, mid);
+    } else if (!found && publishing_sensor) {
+        reading_queue_ack_unsent(&publishing_sensor->queue, mid);
+    }
+    drain_queue(false);
+}
+
+/**
+ * Batch max latency expired: send the partial batch
+ */
+static void on_batch_timer(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    timer_fd_consume(fd);
+    batch_timer_armed = false;
+    drain_queue(true);
+}
+
+/**
+ * Report by exception: check whether a reading stays inside the deadband
+ * around the last published values (and the heartbeat is not due)
+ */
+static bool deadband_suppresses(sensor_t* sensor, const sensor_reading_t* reading) {
+    // Thresholds in hundredths, like the compared values (0 = not watched)
+    int32_t band_temperature = (int32_t)(g_config.deadband_temperature * 100.0f + 0.5f);
+    int32_t band_humidity = (int32_t)(g_config.deadband_humidity * 100.0f + 0.5f);
+    if (band_temperature == 0 && band_humidity == 0) {
+        return false;
+    }
+    
+    // Half an interval of slack: a sample landing just before the heartbeat
+    // deadline publishes, instead of the next one a whole interval late
+    uint64_t now_ms = schedule_monotonic_ms();
+    uint64_t silence_ms = now_ms - sensor->published_ms + (uint64_t)g_config.read_interval * 500;
+    bool heartbeat_due = (silence_ms >= (uint64_t)g_config.heartbeat_seconds * 1000);
+    
+    int32_t delta_temperature = abs(reading->temperature_centi - sensor->published_temperature_centi);
+    int32_t delta_humidity = abs(reading->humidity_centi - sensor->published_humidity_centi);
+    bool changed = (band_temperature > 0 && delta_temperature > band_temperature) ||
+                   (band_humidity > 0 && delta_humidity > band_humidity);
+    
+    if (sensor->has_published && !changed && !heartbeat_due) {
+        sensor->suppressed++;
+        return true;
+    }
+    
+    sensor->has_published = true;
+    sensor->published_temperature_centi = reading->temperature_centi;
+    sensor->published_humidity_centi = reading->humidity_centi;
+    sensor->published_ms = now_ms;
+    return false;
+}
+
+/**
+ * Apply calibration offsets and publish a sensor reading
+ */
+static void publish_reading(sensor_t* sensor, sensor_reading_t* reading) {
+    // Apply calibration offsets
+    reading->temperature += sensor->temp_offset;
+    reading->humidity += sensor->humidity_offset;
+    reading->temperature_centi += sensor->temp_offset_centi;
+    reading->humidity_centi += sensor->humidity_offset_centi;
+    
+    // Every reading feeds the aggregates, published on its own or not
+    bool bucket_closed = false;
+    for (int w = 0; w < sensor->aggregate_count; w++) {
+        bucket_closed |= aggregate_add(&sensor->aggregates[w], reading);
+    }
+    
+    bool publish = g_config.publish_raw;
+    if (publish && deadband_suppresses(sensor, reading)) {
+        LOG_DEBUG_F("%s T: %.2f°C, H: %.2f%% inside the deadband, not published", sensor->id,
+                    reading->temperature, reading->humidity);
+        publish = false;
+    }
+    if (!publish) {
+        if (bucket_closed) {
+            drain_queue(false);
+        }
+        return;
+    }
+    
+    LOG_INFO_F("📊 %s T: %.2f°C, H: %.2f%%, TS: %llu", sensor->id,
+              reading->temperature, reading->humidity, reading->timestamp);
+    
+    // Store first, publish from the queue (retired on PUBACK)
+    if (reading_queue_push(&sensor->queue, reading) != TECHTEMP_OK) {
+        LOG_WARN_F("⚠️  Failed to queue reading of %s", sensor->id);
+        return;
+    }
+    
+    // Sampled at the slot boundary: publish at this device's offset
+    if (g_config.schedule_mode == SCHEDULE_BOUNDARY && phase_offset_ms > 0) {
+        if (timer_fd_arm_abs_ms(publish_timer, sample_slot_ms + phase_offset_ms) == TECHTEMP_OK) {
+            publish_held = true;
+            return;
+        }
+    }
+    
+    if (!mqtt_is_connected()) {
+        LOG_WARN_F("⚠️  MQTT not connected, reading queued (%u pending)", total_depth());
+        return;
+    }
+    
+    drain_queue(false);
+}
+
+/**
+ * Publish offset reached (boundary schedule): send the held readings
+ */
+static void on_publish_timer(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    timer_fd_consume(fd);
+    publish_held = false;
+    drain_queue(false);
+}
+
+/**
+ * Arm the sample timer for the next deadline
+ * (free: fixed period, spread: boundary + device offset, boundary: exact boundary)
+ */
+static int arm_sample_timer(void) {
+    uint32_t interval_ms = (uint32_t)g_config.read_interval * 1000;
+    if (g_config.schedule_mode == SCHEDULE_FREE) {
+        slot_deadline_ms = schedule_next_period_ms(slot_deadline_ms, interval_ms, NULL);
+        return timer_fd_arm_abs_ms(sample_timer, slot_deadline_ms);
+    }
+    
+    uint32_t offset_ms = (g_config.schedule_mode == SCHEDULE_SPREAD) ? phase_offset_ms : 0;
+    
+    uint64_t previous_deadline_ms = slot_deadline_ms;
+    slot_deadline_ms = schedule_next_slot_ms(interval_ms, offset_ms);
+    
+    // Timer fired a little early or NTP stepped back: never sample twice per slot
+    if (previous_deadline_ms != 0 && slot_deadline_ms < previous_deadline_ms + interval_ms / 2) {
+        slot_deadline_ms = schedule_next_slot_ms(interval_ms, offset_ms) + interval_ms;
+    }
+    
+    return timer_fd_arm_abs_ms(sample_timer, slot_deadline_ms);
+}
+
+/**
+ * Signal received through the signalfd
+ */
+static void on_signal_event(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    struct signalfd_siginfo info;
+    while (read(fd, &info, sizeof(info)) == sizeof(info)) {
+        signal_handler((int)info.ssi_signo);
+    }
+}
+
+/**
+ * Sampling schedule tick: start a measurement cycle over all sensors
+ */
+static void on_sample_timer(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    timer_fd_consume(fd);
+    
+    // Re-arm first: the next deadline never depends on the cycle
+    sample_slot_ms = slot_deadline_ms;
+    arm_sample_timer();
+    
+    if (acquisition_start_cycle(sample_slot_ms * 1000) != TECHTEMP_OK) {
+        LOG_WARN_F("⚠️  Previous measurement still in progress, skipping sample");
+    }
+}
+
+/**
+ * Reading taken from an acquisition ring
+ */
+static void on_sensor_reading(int sensor_index, sensor_reading_t* reading) {
+    metric_inc(readings_metric);
+    publish_reading(sensor_registry_get(sensor_index), reading);
+}
+
+/**
+ * Readings available from the acquisition threads: publish them
+ */
+static void on_acquisition_done(int fd, uint32_t events, void* ctx) {
+    (void)fd;
+    (void)events;
+    (void)ctx;
+    
+    acquisition_drain(on_sensor_reading);
+}
+
+/**
+ * MQTT socket readable/writable
+ */
+static void on_mqtt_socket(int fd, uint32_t events, void* ctx) {
+    (void)fd;
+    (void)ctx;
+    
+    bool readable = (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0;
+    bool writable = (events & EPOLLOUT) != 0;
+    
+    if (mqtt_handle_events(readable, writable) != TECHTEMP_OK) {
+        LOG_WARN_F("MQTT connection lost: %s", mqtt_get_error());
+    }
+}
+
+/**
+ * Random number for backoff jitter (xorshift32, seeded per device)
+ */
+static uint32_t next_jitter(void) {
+    uint32_t x = jitter_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    jitter_state = x;
+    return x;
+}
+
+/**
+ * Arm the reconnection timer: exponential backoff with full jitter,
+ * a random delay in [0, min(cap, base * 2^attempt)]
+ */
+static void schedule_reconnect(void) {
+    uint64_t base_ms = (uint64_t)g_config.mqtt_reconnect_delay * 1000;
+    uint64_t cap_ms = (uint64_t)g_config.mqtt_reconnect_max_delay * 1000;
+    int shift = reconnect_attempt < MQTT_BACKOFF_MAX_SHIFT ? reconnect_attempt : MQTT_BACKOFF_MAX_SHIFT;
+    uint64_t ceiling_ms = base_ms << shift;
+    if (ceiling_ms > cap_ms) {
+        ceiling_ms = cap_ms;
+    }
+    
+    uint64_t delay_ms = next_jitter() % (ceiling_ms + 1);
+    TECHTEMP_PROBE2(reconnect_scheduled, reconnect_attempt + 1, delay_ms);
+    LOG_INFO_F("MQTT reconnection in %llu ms (attempt %d)",
+               (unsigned long long)delay_ms, reconnect_attempt + 1);
+    
+    // 0 would disarm the timer
+    timer_fd_arm_ms(reconnect_timer, delay_ms > 0 ? delay_ms : 1, 0);
+}
+
+/**
+ * Stop watching the MQTT socket (a new connection may reuse the fd number)
+ */
+static void drop_mqtt_watch(void) {
+    if (mqtt_watch_fd != -1) {
+        event_loop_remove(mqtt_watch_fd);
+        mqtt_watch_fd = -1;
+    }
+}
+
+/**
+ * A connection attempt failed (refused, socket error or timeout)
+ */
+static void on_connect_failed(void) {
+    connect_pending = false;
+    reconnect_attempt++;
+    metric_inc(connect_failure_metric);
+    LOG_WARN_F("MQTT connection failed (%d in a row): %s", reconnect_attempt, mqtt_get_error());
+    
+    // In-process equivalent of the former systemd restart
+    if (g_config.mqtt_max_reconnect_attempts > 0 &&
+        reconnect_attempt % g_config.mqtt_max_reconnect_attempts == 0) {
+        LOG_ERROR_F("💥 MQTT failed %d times, recreating the client", reconnect_attempt);
+        drop_mqtt_watch();
+        if (mqtt_reinit() != TECHTEMP_OK) {
+            LOG_ERROR_F("Failed to recreate MQTT client: %s", mqtt_get_error());
+        }
+    }
+    
+    schedule_reconnect();
+}
+
+/**
+ * Reconnection timer: start an attempt, or give up on one that timed out
+ */
+static void on_reconnect_timer(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    timer_fd_consume(fd);
+    
+    if (mqtt_is_connected()) {
+        return;
+    }
+    
+    if (connect_pending) {
+        mqtt_abort_connect();
+        on_connect_failed();
+        return;
+    }
+    
+    drop_mqtt_watch();
+    if (mqtt_connect() != TECHTEMP_OK) {
+        on_connect_failed();
+        return;
+    }
+    
+    // Same timer bounds the handshake
+    connect_pending = true;
+    timer_fd_arm_ms(fd, MQTT_CONNECT_TIMEOUT_MS, 0);
+}
+
+/**
+ * Follow the connection attempt started by on_reconnect_timer
+ */
+static void sync_connection_state(void) {
+    if (!connect_pending) {
+        return;
+    }
+    
+    if (mqtt_is_connected()) {
+        if (reconnect_attempt > 0) {
+            LOG_INFO_F("✅ MQTT reconnected successfully after %d failures", reconnect_attempt);
+        }
+        if (ever_connected) {
+            metric_inc(reconnect_metric);
+        }
+        ever_connected = true;
+        connect_pending = false;
+        reconnect_attempt = 0;
+        timer_fd_arm_ms(reconnect_timer, 0, 0);
+    } else if (!mqtt_is_connecting()) {
+        // Refused by the broker or socket error before the timeout
+        on_connect_failed();
+    }
+}
+
+/**
+ * Get the resident set size of the process in KiB
+ */
+static uint64_t resident_kb(void) {
+    char buffer[64];
+    int fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= 0) {
+        return 0;
+    }
+    buffer[length] = '\0';
+    
+    // Second field: resident pages
+    unsigned long long pages = 0;
+    if (sscanf(buffer, "%*s %llu", &pages) != 1) {
+        return 0;
+    }
+    return pages * (uint64_t)sysconf(_SC_PAGESIZE) / 1024;
+}
+
+/**
+ * Take a self-telemetry snapshot
+ */
+static void collect_stats(device_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->timestamp = get_timestamp_ms();
+    stats->uptime_s = (schedule_monotonic_ms() - start_ms) / 1000;
+    stats->readings = (uint64_t)metric_value(readings_metric);
+    stats->published = (uint64_t)metric_value(metric_find("techtemp_readings_published_total"));
+    stats->dropped = (uint64_t)metric_value(metric_find("techtemp_acquisition_dropped_total")) +
+                     (uint64_t)metric_value(metric_find("techtemp_queue_dropped_total"));
+    const metric_t* latency = metric_find("techtemp_mqtt_publish_ack_latency_us");
+    stats->publish_latency_p50_us = metric_percentile(latency, 50);
+    stats->publish_latency_p99_us = metric_percentile(latency, 99);
+    stats->i2c_errors = (uint64_t)metric_value(metric_find("techtemp_i2c_errors_total"));
+    stats->reconnects = (uint64_t)metric_value(reconnect_metric);
+    stats->rss_kb = resident_kb();
+    stats->queue_depth = total_depth();
+    for (int i = 0; i < sensor_registry_count(); i++) {
+        stats->suppressed += sensor_registry_get(i)->suppressed;
+    }
+    
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        stats->cpu_ms = (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+                        (uint64_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+    }
+}
+
+/**
+ * Stats tick: publish a snapshot (skipped while disconnected, the next
+ * one carries the same totals)
+ */
+static void on_stats_timer(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    timer_fd_consume(fd);
+    if (!mqtt_is_connected()) {
+        LOG_DEBUG_F("MQTT not connected, stats snapshot skipped");
+        return;
+    }
+    
+    device_stats_t stats;
+    collect_stats(&stats);
+    if (mqtt_publish_stats(&stats, stats_topic) != TECHTEMP_OK) {
+        LOG_WARN_F("⚠️  Failed to publish stats: %s", mqtt_get_error());
+    }
+}
+
+/**
+ * MQTT housekeeping tick: keepalive pings
+ */
+static void on_misc_timer(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    timer_fd_consume(fd);
+    if (mqtt_is_connected()) {
+        mqtt_handle_misc();
+    }
+}
+
+/**
+ * Follow MQTT connection transitions for the store-and-forward queue
+ */
+static void sync_queue_state(void) {
+    bool connected = mqtt_is_connected();
+    if (connected == mqtt_was_connected) {
+        return;
+    }
+    
+    mqtt_was_connected = connected;
+    if (connected) {
+        if (total_depth() > 0) {
+            LOG_INFO_F("Draining %u queued readings", total_depth());
+        }
+        drain_queue(true);
+    } else {
+        // Unacknowledged readings and aggregates will be published again after reconnection
+        for (int i = 0; i < sensor_registry_count(); i++) {
+            sensor_t* sensor = sensor_registry_get(i);
+            reading_queue_rewind(&sensor->queue);
+            for (int w = 0; w < sensor->aggregate_count; w++) {
+                aggregate_rewind(&sensor->aggregates[w]);
+            }
+        }
+        if (!connect_pending) {
+            LOG_WARN_F("MQTT connection lost");
+            schedule_reconnect();
+        }
+    }
+}
+
+/**
+ * Keep the event loop watch in sync with the MQTT socket
+ * (the socket changes on reconnection, write interest follows the outgoing queue)
+ */
+static void sync_mqtt_watch(void) {
+    int fd = mqtt_get_socket();
+    uint32_t events = EPOLLIN | (mqtt_want_write() ? EPOLLOUT : 0);
+    
+    if (fd != mqtt_watch_fd) {
+        if (mqtt_watch_fd != -1) {
+            event_loop_remove(mqtt_watch_fd);
+            mqtt_watch_fd = -1;
+        }
+        if (fd != -1 && event_loop_add(fd, events, on_mqtt_socket, NULL) == TECHTEMP_OK) {
+            mqtt_watch_fd = fd;
+            mqtt_watch_events = events;
+        }
+    } else if (fd != -1 && events != mqtt_watch_events) {
+        if (event_loop_modify(fd, events) == TECHTEMP_OK) {
+            mqtt_watch_events = events;
+        }
+    }
+}
+
 /**
  * Main application entry point
  */
 int main(int argc, char* argv[]) {
     int result = TECHTEMP_OK;
-    sensor_reading_t reading;
     const char* config_file = NULL;
     
     // Parse command line arguments
@@ -36,7 +674,11 @@ int main(int argc, char* argv[]) {
     printf("Starting TechTemp Device Client...\n");
     
     // Setup signal handlers for graceful shutdown
-    setup_signal_handlers();
+    int signal_fd = setup_signal_handlers();
+    if (signal_fd < 0) {
+        LOG_ERROR_F("Failed to setup signal handling: %s", strerror(errno));
+        return EXIT_FAILURE;
+    }
     
     // Load configuration
     LOG_INFO_F("Loading configuration...");
@@ -52,16 +694,48 @@ int main(int argc, char* argv[]) {
         LOG_ERROR_F("Invalid configuration");
         return EXIT_FAILURE;
     }
+    log_init(g_config.log_level, g_config.log_to_file ? g_config.log_file : NULL, g_config.log_to_console);
+    if (g_config.log_async) {
+        log_start_async(g_config.log_block_when_full);
+    }
+    if (g_config.log_trace_file[0] != '\0') {
+        log_trace_open(g_config.log_trace_file, g_config.log_trace_size_kb, g_config.log_trace_level);
+    }
     
     LOG_INFO_F("Device UID: %s", g_config.device_uid);
     LOG_INFO_F("Device Label: %s", g_config.label);
     LOG_INFO_F("Read interval: %d seconds", g_config.read_interval);
     
-    // Initialize AHT20 sensor
-    LOG_INFO_F("Initializing AHT20 sensor...");
-    result = aht20_init(g_config.i2c_bus, g_config.i2c_address);
+    // Deterministic sampling: no page fault on the sampling path
+    if (g_config.realtime && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        LOG_WARN_F("⚠️  mlockall failed, memory may be paged out: %s", strerror(errno));
+    }
+    
+    // No sensor attached (simulation, CI): emulated AHT20s behind the same driver
+    if (g_config.emulator_enabled) {
+        aht20_emulator_config_t emulator_cfg = {
+            .conversion_ms = g_config.emulator_conversion_ms,
+            .conversion_jitter_ms = g_config.emulator_conversion_jitter_ms,
+            .bus_khz = g_config.emulator_bus_khz,
+            .nack_rate = g_config.emulator_nack_rate,
+            .error_rate = g_config.emulator_error_rate,
+            .crc_error_rate = g_config.emulator_crc_error_rate,
+            .brownout_rate = g_config.emulator_brownout_rate,
+            .period_seconds = g_config.emulator_period_seconds,
+            .seed = g_config.emulator_seed
+        };
+        aht20_emulator_configure(&emulator_cfg);
+        aht20_set_transport(&aht20_emulator_transport);
+        LOG_WARN_F("🧪 Emulated AHT20 sensors (%d ms conversion, %d kHz bus, seed %u)",
+                   g_config.emulator_conversion_ms, g_config.emulator_bus_khz, g_config.emulator_seed);
+    }
+    
+    // Initialize the AHT20 sensors and their store-and-forward queues
+    LOG_INFO_F("Initializing %d AHT20 sensor(s)...", g_config.sensor_count);
+    result = sensor_registry_init(&g_config);
     if (result != TECHTEMP_OK) {
-        LOG_ERROR_F("Failed to initialize AHT20 sensor: %s", aht20_get_error());
+        LOG_ERROR_F("Failed to initialize AHT20 sensors");
+        sensor_registry_cleanup();
         return EXIT_FAILURE;
     }
     
@@ -73,7 +747,8 @@ int main(int argc, char* argv[]) {
         .port = g_config.mqtt_port,
         .qos = g_config.mqtt_qos,
         .keepalive = g_config.mqtt_keepalive,
-        .connect_timeout_ms = 5000,
+        .connect_timeout_ms = MQTT_CONNECT_TIMEOUT_MS,
+        .payload_format = g_config.mqtt_payload_format,
         .use_tls = false
     };
     
@@ -84,121 +759,187 @@ int main(int argc, char* argv[]) {
     strncpy(mqtt_cfg.username, g_config.mqtt_username, sizeof(mqtt_cfg.username) - 1);
     strncpy(mqtt_cfg.password, g_config.mqtt_password, sizeof(mqtt_cfg.password) - 1);
 #pragma GCC diagnostic pop
-    
+
+    // Default topics: the first sensor's (each sensor publishes on its own)
     snprintf(mqtt_cfg.client_id, sizeof(mqtt_cfg.client_id), "techtemp-%s", g_config.device_uid);
-    snprintf(mqtt_cfg.topic, sizeof(mqtt_cfg.topic), "home/%s/sensors/%s/reading", 
-             g_config.home_id, g_config.device_uid);
+    snprintf(mqtt_cfg.topic, sizeof(mqtt_cfg.topic), "%s", sensor_registry_get(0)->topic);
+    snprintf(mqtt_cfg.batch_topic, sizeof(mqtt_cfg.batch_topic), "%s", sensor_registry_get(0)->batch_topic);
     
     result = mqtt_init(&mqtt_cfg);
     if (result != TECHTEMP_OK) {
         LOG_ERROR_F("Failed to initialize MQTT client: %s", mqtt_get_error());
-        aht20_cleanup();
+        sensor_registry_cleanup();
         return EXIT_FAILURE;
     }
+    mqtt_set_publish_callback(on_reading_acked);
+    
+    LOG_INFO_F("🚀 TechTemp Device Client started successfully!");
+    LOG_INFO_F("Publishing sensor readings every %d seconds...", g_config.read_interval);
+    
+    // Event sources: signals, sampling schedule, sensor conversion, MQTT housekeeping
+    // and connection (first attempt right away, sampling starts regardless)
+    sample_timer = timer_fd_create();
+    int misc_timer = timer_fd_create();
+    reconnect_timer = timer_fd_create();
+    jitter_state = (uint32_t)getpid() ^ (uint32_t)get_timestamp_ms();
+    for (const char* c = g_config.device_uid; *c; c++) {
+        jitter_state = (jitter_state ^ (uint8_t)*c) * 16777619u;
+    }
+    if (jitter_state == 0) {
+        jitter_state = 1;
+    }
+    int misc_interval_ms = g_config.mqtt_keepalive * 1000 / 4;
+    if (misc_interval_ms < 1000) {
+        misc_interval_ms = 1000;
+    }
+    
+    if (event_loop_init() != TECHTEMP_OK ||
+        sample_timer < 0 || misc_timer < 0 || reconnect_timer < 0 ||
+        event_loop_add(signal_fd, EPOLLIN, on_signal_event, NULL) != TECHTEMP_OK ||
+        event_loop_add(sample_timer, EPOLLIN, on_sample_timer, NULL) != TECHTEMP_OK ||
+        event_loop_add(misc_timer, EPOLLIN, on_misc_timer, NULL) != TECHTEMP_OK ||
+        event_loop_add(reconnect_timer, EPOLLIN, on_reconnect_timer, NULL) != TECHTEMP_OK ||
+        timer_fd_arm_ms(misc_timer, misc_interval_ms, misc_interval_ms) != TECHTEMP_OK ||
+        timer_fd_arm_ms(reconnect_timer, 1, 0) != TECHTEMP_OK) {
+        LOG_ERROR_F("Failed to setup event loop");
+        g_running = false;
+    }
+    reconnect_metric = metric_register("techtemp_mqtt_reconnects_total",
+                                       "MQTT connections established after the first one", METRIC_COUNTER);
+    connect_failure_metric = metric_register("techtemp_mqtt_connect_failures_total",
+                                             "Failed MQTT connection attempts", METRIC_COUNTER);
+    readings_metric = metric_register("techtemp_readings_total",
+                                      "Valid readings taken, all sensors", METRIC_COUNTER);
+    
+    // Sensors are read by one acquisition thread per I2C bus
+    if (acquisition_init(&g_config) != TECHTEMP_OK ||
+        event_loop_add(acquisition_get_fd(), EPOLLIN, on_acquisition_done, NULL) != TECHTEMP_OK) {
+        LOG_ERROR_F("Failed to setup sensor acquisition");
+        g_running = false;
+    }
     
-    // Connect to MQTT broker
-    LOG_INFO_F("Connecting to MQTT broker %s:%d...", g_config.mqtt_host, g_config.mqtt_port);
-    result = mqtt_connect();
+    // Sampling schedule: free-running from now, or aligned on wall-clock slots
+    // (real-time mode: the acquisition pacer thread keeps the schedule)
+    phase_offset_ms = schedule_phase_offset_ms(g_config.device_uid, (uint32_t)g_config.read_interval * 1000);
+    if (g_config.realtime) {
+        result = TECHTEMP_OK;
+    } else {
+        result = arm_sample_timer();
+        if (g_config.schedule_mode != SCHEDULE_FREE) {
+            LOG_INFO_F("Sampling aligned on %d s slots, device offset %u ms (%s)", g_config.read_interval,
+                       phase_offset_ms, g_config.schedule_mode == SCHEDULE_SPREAD ? "sample" : "publish");
+        }
+    }
+    if (g_config.schedule_mode == SCHEDULE_BOUNDARY) {
+        publish_timer = timer_fd_create();
+        if (publish_timer < 0 || event_loop_add(publish_timer, EPOLLIN, on_publish_timer, NULL) != TECHTEMP_OK) {
+            result = TECHTEMP_ERROR;
+        }
+    }
     if (result != TECHTEMP_OK) {
-        LOG_ERROR_F("Failed to connect to MQTT broker: %s", mqtt_get_error());
-        mqtt_cleanup();
-        aht20_cleanup();
-        return EXIT_FAILURE;
+        LOG_ERROR_F("Failed to setup sampling schedule");
+        g_running = false;
     }
     
-    LOG_INFO_F("🚀 TechTemp Device Client started successfully!");
-    LOG_INFO_F("Publishing sensor readings every %d seconds...", g_config.read_interval);
+    // Local OpenMetrics exporter, served by this loop
+    if (metrics_server_start(g_config.metrics_socket, g_config.metrics_port) != TECHTEMP_OK) {
+        LOG_ERROR_F("Failed to setup metrics exporter");
+        g_running = false;
+    }
     
-    // Main application loop
-    while (g_running) {
-        // Process MQTT events
-        mqtt_loop(100);
-        
-        // Check if it's time to read sensor
-        static time_t last_reading = 0;
-        time_t now = time(NULL);
-        
-        if ((now - last_reading) >= g_config.read_interval) {
-            LOG_DEBUG_F("Reading sensor data...");
-            
-            // Read sensor data
-            result = aht20_read(&reading);
-            if (result == TECHTEMP_OK && reading.valid) {
-                // Apply calibration offsets
-                reading.temperature += g_config.temp_offset;
-                reading.humidity += g_config.humidity_offset;
-                
-                LOG_INFO_F("📊 T: %.2f°C, H: %.2f%%, TS: %llu", 
-                          reading.temperature, reading.humidity, reading.timestamp);
-                
-                // Publish to MQTT
-                result = mqtt_publish_reading(&reading, g_config.device_uid);
-                if (result == TECHTEMP_OK) {
-                    LOG_DEBUG_F("✅ Data published successfully");
-                } else {
-                    LOG_WARN_F("⚠️  Failed to publish data: %s", mqtt_get_error());
-                }
-            } else {
-                LOG_WARN_F("⚠️  Failed to read sensor: %s", aht20_get_error());
-            }
-            
-            last_reading = now;
+    // Self-telemetry on the device stats topic, rate limited by its period
+    start_ms = schedule_monotonic_ms();
+    if (g_config.stats_interval > 0) {
+        uint64_t stats_interval_ms = (uint64_t)g_config.stats_interval * 1000;
+        snprintf(stats_topic, sizeof(stats_topic), MQTT_STATS_TOPIC_TEMPLATE, g_config.home_id, g_config.device_uid);
+        stats_timer = timer_fd_create();
+        if (stats_timer < 0 || event_loop_add(stats_timer, EPOLLIN, on_stats_timer, NULL) != TECHTEMP_OK ||
+            timer_fd_arm_ms(stats_timer, stats_interval_ms, stats_interval_ms) != TECHTEMP_OK) {
+            LOG_ERROR_F("Failed to setup stats timer");
+            g_running = false;
         }
-        
-        // Check MQTT connection status with fail-fast logic
-        static int mqtt_failure_count = 0;
-        const int MAX_MQTT_FAILURES = 5;
-        
-        if (!mqtt_is_connected()) {
-            LOG_WARN_F("MQTT disconnected, attempting reconnection... (attempt %d/%d)", 
-                      mqtt_failure_count + 1, MAX_MQTT_FAILURES);
-            
-            if (mqtt_connect() != TECHTEMP_OK) {
-                mqtt_failure_count++;
-                if (mqtt_failure_count >= MAX_MQTT_FAILURES) {
-                    LOG_ERROR_F("💥 MQTT failed %d times, exiting for systemd restart", mqtt_failure_count);
-                    g_running = false;
-                    break;
-                }
-                LOG_WARN_F("MQTT reconnection failed (%d/%d), will retry...", mqtt_failure_count, MAX_MQTT_FAILURES);
-            } else {
-                // Reset counter on successful connection
-                if (mqtt_failure_count > 0) {
-                    LOG_INFO_F("✅ MQTT reconnected successfully after %d failures", mqtt_failure_count);
-                }
-                mqtt_failure_count = 0;
-            }
-        } else {
-            // Reset failure counter when connected
-            mqtt_failure_count = 0;
+    }
+    
+    // Opt-in batching: N readings per message, or at most batch_max_latency_ms
+    if (g_config.mqtt_batch_size > 1) {
+        batch_timer = timer_fd_create();
+        if (batch_timer < 0 || event_loop_add(batch_timer, EPOLLIN, on_batch_timer, NULL) != TECHTEMP_OK) {
+            LOG_ERROR_F("Failed to setup batch timer");
+            g_running = false;
         }
+        LOG_INFO_F("Batching up to %d readings per message (max latency %d ms)",
+                   g_config.mqtt_batch_size, g_config.mqtt_batch_max_latency_ms);
+    }
+    
+    // Main application loop: sleep until something happens
+    while (g_running) {
+        sync_connection_state();
+        sync_queue_state();
+        sync_mqtt_watch();
         
-        // Small delay to prevent CPU spinning
-        usleep(100000); // 100ms
+        if (event_loop_run_once(-1) < 0) {
+            LOG_ERROR_F("Event loop failure, exiting");
+            break;
+        }
     }
     
+    metrics_server_stop();
+    event_loop_cleanup();
+    if (sample_timer >= 0) {
+        close(sample_timer);
+    }
+    if (misc_timer >= 0) {
+        close(misc_timer);
+    }
+    if (reconnect_timer >= 0) {
+        close(reconnect_timer);
+    }
+    if (publish_timer >= 0) {
+        close(publish_timer);
+    }
+    if (batch_timer >= 0) {
+        close(batch_timer);
+    }
+    if (stats_timer >= 0) {
+        close(stats_timer);
+    }
+    close(signal_fd);
+    
     // Graceful shutdown
     LOG_INFO_F("Shutting down TechTemp Device Client...");
     
     mqtt_disconnect();
     mqtt_cleanup();
-    aht20_cleanup();
+    acquisition_cleanup();
+    sensor_registry_cleanup();
+    metrics_log();
     
     LOG_INFO_F("✅ TechTemp Device Client stopped");
+    log_trace_close();
+    log_cleanup();
     return EXIT_SUCCESS;
 }
 
 /**
- * Setup signal handlers for graceful shutdown
+ * Setup signal handling for graceful shutdown
+ * Signals are blocked and delivered through a signalfd watched by the event loop
  */
-void setup_signal_handlers(void) {
-    signal(SIGINT, signal_handler);   // Ctrl+C
-    signal(SIGTERM, signal_handler);  // Termination request
-    signal(SIGHUP, signal_handler);   // Hangup
+int setup_signal_handlers(void) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);   // Ctrl+C
+    sigaddset(&mask, SIGTERM);  // Termination request
+    sigaddset(&mask, SIGHUP);   // Hangup
+    
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) != 0) {
+        return -1;
+    }
+    
+    return signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
 }
 
 /**
- * Signal handler for graceful shutdown
+ * Signal handler for graceful shutdown (called from the event loop)
  */
 void signal_handler(int signum) {
     const char* signal_name;
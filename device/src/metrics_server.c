@@ -0,0 +1,407 @@
+/**
+ * @file metrics_server.c
+ * @brief OpenMetrics exporter implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#define _GNU_SOURCE  // Pour accept4()
+#include "metrics_server.h"
+#include "event_loop.h"
+#include "payload_codec.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define MAX_LISTENERS      2     // Unix socket + loopback port
+#define HEADER_RESERVE     192   // Room left in front of the body for the status line and headers
+
+// Response being written to the current client
+typedef struct {
+    size_t start;                // First byte of the response in response[]
+    size_t length;               // End of the response in response[]
+    size_t sent;                 // Offset of the next byte to send
+} response_state_t;
+
+// Internal state
+static int listeners[MAX_LISTENERS] = { -1, -1 };
+static char socket_file[sizeof(((struct sockaddr_un*)0)->sun_path)] = "";
+static int client_fd = -1;
+static char request[METRICS_SERVER_REQUEST_MAX];
+static size_t request_length = 0;
+static bool responding = false;
+static char response[METRICS_SERVER_BUFFER_SIZE];
+static response_state_t state;
+static bool overflow_logged = false;
+
+// Internal helper functions
+static int listen_unix(const char* path);
+static int listen_loopback(int port);
+static int add_listener(int fd);
+static void on_listener_ready(int fd, uint32_t events, void* ctx);
+static void on_client_event(int fd, uint32_t events, void* ctx);
+static void close_client(void);
+static bool request_complete(void);
+static void build_response(void);
+static size_t render_metrics(char* buffer, size_t size);
+static size_t render_metric(char* buffer, size_t size, const metric_t* metric);
+static bool put_text(char* buffer, size_t size, size_t* written, const char* text);
+static bool put_u64(char* buffer, size_t size, size_t* written, uint64_t value);
+static void send_response(void);
+
+/**
+ * Start listening and watch the sockets in the event loop
+ */
+int metrics_server_start(const char* socket_path, int port) {
+    if (socket_path && socket_path[0] != '\0') {
+        if (add_listener(listen_unix(socket_path)) != TECHTEMP_OK) {
+            metrics_server_stop();
+            return TECHTEMP_ERROR;
+        }
+        LOG_INFO_F("Metrics served on unix:%s", socket_path);
+    }
+    
+    if (port > 0) {
+        if (add_listener(listen_loopback(port)) != TECHTEMP_OK) {
+            metrics_server_stop();
+            return TECHTEMP_ERROR;
+        }
+        LOG_INFO_F("Metrics served on http://127.0.0.1:%d/metrics", port);
+    }
+    return TECHTEMP_OK;
+}
+
+/**
+ * Close the sockets
+ */
+void metrics_server_stop(void) {
+    close_client();
+    for (int i = 0; i < MAX_LISTENERS; i++) {
+        if (listeners[i] >= 0) {
+            event_loop_remove(listeners[i]);
+            close(listeners[i]);
+            listeners[i] = -1;
+        }
+    }
+    if (socket_file[0] != '\0') {
+        unlink(socket_file);
+        socket_file[0] = '\0';
+    }
+}
+
+// Internal helper functions
+
+static int listen_unix(const char* path) {
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        LOG_ERROR_F("Metrics socket path too long: %s", path);
+        return -1;
+    }
+    memcpy(address.sun_path, path, strlen(path) + 1);
+    
+    // Left behind by a crash: only ever remove a socket
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR_F("Failed to create metrics socket: %s", strerror(errno));
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(fd, METRICS_SERVER_BACKLOG) != 0) {
+        LOG_ERROR_F("Failed to listen on %s: %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    memcpy(socket_file, address.sun_path, sizeof(socket_file));
+    return fd;
+}
+
+static int listen_loopback(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR_F("Failed to create metrics socket: %s", strerror(errno));
+        return -1;
+    }
+    
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    // Loopback only: the exporter is never reachable from the network
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(fd, METRICS_SERVER_BACKLOG) != 0) {
+        LOG_ERROR_F("Failed to listen on 127.0.0.1:%d: %s", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int add_listener(int fd) {
+    if (fd < 0) {
+        return TECHTEMP_ERROR;
+    }
+    
+    for (int i = 0; i < MAX_LISTENERS; i++) {
+        if (listeners[i] < 0) {
+            if (event_loop_add(fd, EPOLLIN, on_listener_ready, NULL) != TECHTEMP_OK) {
+                break;
+            }
+            listeners[i] = fd;
+            return TECHTEMP_OK;
+        }
+    }
+    
+    close(fd);
+    return TECHTEMP_ERROR;
+}
+
+static void on_listener_ready(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    
+    int fd_client = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd_client < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            LOG_WARN_F("Metrics accept failed: %s", strerror(errno));
+        }
+        return;
+    }
+    
+    // One scrape at a time: a newer connection replaces a stalled one
+    if (client_fd >= 0) {
+        LOG_DEBUG_F("Metrics client replaced before its response completed");
+        close_client();
+    }
+    if (event_loop_add(fd_client, EPOLLIN, on_client_event, NULL) != TECHTEMP_OK) {
+        close(fd_client);
+        return;
+    }
+    client_fd = fd_client;
+    request_length = 0;
+    responding = false;
+}
+
+static void on_client_event(int fd, uint32_t events, void* ctx) {
+    (void)fd;
+    (void)ctx;
+    
+    if (responding) {
+        send_response();
+        return;
+    }
+    
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        close_client();
+        return;
+    }
+    
+    // Headers up to the blank line; only the request line matters
+    ssize_t length = read(client_fd, request + request_length, sizeof(request) - 1 - request_length);
+    if (length < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    if (length <= 0) {
+        close_client();
+        return;
+    }
+    request_length += (size_t)length;
+    request[request_length] = '\0';
+    
+    if (request_complete()) {
+        build_response();
+        responding = true;
+        event_loop_modify(client_fd, EPOLLOUT);
+        send_response();
+    }
+}
+
+static void close_client(void) {
+    if (client_fd >= 0) {
+        event_loop_remove(client_fd);
+        close(client_fd);
+        client_fd = -1;
+    }
+    responding = false;
+}
+
+static bool request_complete(void) {
+    return strstr(request, "\r\n\r\n") != NULL || strstr(request, "\n\n") != NULL ||
+           request_length == sizeof(request) - 1;
+}
+
+static void build_response(void) {
+    const char* status = "200 OK";
+    const char* content_type = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    size_t body_start = HEADER_RESERVE;
+    size_t body_length = 0;
+    
+    if (strncmp(request, "GET ", 4) != 0) {
+        status = "405 Method Not Allowed";
+        content_type = "text/plain";
+    } else if (strncmp(request + 4, "/metrics ", 9) != 0 && strncmp(request + 4, "/ ", 2) != 0) {
+        status = "404 Not Found";
+        content_type = "text/plain";
+    } else {
+        body_length = render_metrics(response + body_start, sizeof(response) - body_start);
+    }
+    
+    // Headers written in the reserved room, just in front of the body
+    char header[HEADER_RESERVE];
+    size_t header_length = 0;
+    put_text(header, sizeof(header), &header_length, "HTTP/1.0 ");
+    put_text(header, sizeof(header), &header_length, status);
+    put_text(header, sizeof(header), &header_length, "\r\nContent-Type: ");
+    put_text(header, sizeof(header), &header_length, content_type);
+    put_text(header, sizeof(header), &header_length, "\r\nContent-Length: ");
+    put_u64(header, sizeof(header), &header_length, body_length);
+    put_text(header, sizeof(header), &header_length, "\r\nConnection: close\r\n\r\n");
+    
+    state.start = body_start - header_length;
+    memcpy(response + state.start, header, header_length);
+    state.length = body_start + body_length;
+    state.sent = state.start;
+}
+
+static size_t render_metrics(char* buffer, size_t size) {
+    size_t written = 0;
+    for (int i = 0; i < metric_count(); i++) {
+        size_t length = render_metric(buffer + written, size - written, metric_get(i));
+        if (length == 0) {
+            if (!overflow_logged) {
+                LOG_WARN_F("⚠️  Metrics exposition truncated (%d bytes buffer)", METRICS_SERVER_BUFFER_SIZE);
+                overflow_logged = true;
+            }
+            break;
+        }
+        written += length;
+    }
+    
+    // Always room for the terminator: the metrics stop short of the end
+    size_t end = written;
+    if (!put_text(buffer, size, &end, "# EOF\n")) {
+        return written;
+    }
+    return end;
+}
+
+static size_t render_metric(char* buffer, size_t size, const metric_t* metric) {
+    // Reserve the "# EOF\n" terminator
+    if (size <= 6) {
+        return 0;
+    }
+    size -= 6;
+    
+    // OpenMetrics counters: family name without the _total suffix of the sample
+    size_t name_length = strlen(metric->name);
+    size_t family_length = name_length;
+    if (metric->type == METRIC_COUNTER && name_length > 6 &&
+        strcmp(metric->name + name_length - 6, "_total") == 0) {
+        family_length -= 6;
+    }
+    
+    char family[128];
+    if (family_length >= sizeof(family)) {
+        return 0;
+    }
+    memcpy(family, metric->name, family_length);
+    family[family_length] = '\0';
+    
+    static const char* type_names[] = { "counter", "gauge", "histogram" };
+    size_t written = 0;
+    bool ok = put_text(buffer, size, &written, "# TYPE ") &&
+              put_text(buffer, size, &written, family) &&
+              put_text(buffer, size, &written, " ") &&
+              put_text(buffer, size, &written, type_names[metric->type]) &&
+              put_text(buffer, size, &written, "\n# HELP ") &&
+              put_text(buffer, size, &written, family) &&
+              put_text(buffer, size, &written, " ") &&
+              put_text(buffer, size, &written, metric->help) &&
+              put_text(buffer, size, &written, "\n");
+    
+    if (metric->type != METRIC_HISTOGRAM) {
+        int64_t value = metric_value(metric);
+        ok = ok && put_text(buffer, size, &written, family) &&
+             put_text(buffer, size, &written, metric->type == METRIC_COUNTER ? "_total " : " ") &&
+             (value >= 0 || put_text(buffer, size, &written, "-")) &&
+             put_u64(buffer, size, &written, value >= 0 ? (uint64_t)value : (uint64_t)0 - (uint64_t)value) &&
+             put_text(buffer, size, &written, "\n");
+        return ok ? written : 0;
+    }
+    
+    // Cumulative buckets, read once: the +Inf bucket and _count always agree
+    uint64_t cumulative = 0;
+    for (int b = 0; b < METRIC_HISTOGRAM_BUCKETS && ok; b++) {
+        cumulative += __atomic_load_n(&metric->buckets[b], __ATOMIC_RELAXED);
+        ok = put_text(buffer, size, &written, family) &&
+             put_text(buffer, size, &written, "_bucket{le=\"");
+        if (b == METRIC_HISTOGRAM_BUCKETS - 1) {
+            ok = ok && put_text(buffer, size, &written, "+Inf");
+        } else {
+            ok = ok && put_u64(buffer, size, &written, metric_bucket_bound(b));
+        }
+        ok = ok && put_text(buffer, size, &written, "\"} ") &&
+             put_u64(buffer, size, &written, cumulative) &&
+             put_text(buffer, size, &written, "\n");
+    }
+    
+    ok = ok && put_text(buffer, size, &written, family) &&
+         put_text(buffer, size, &written, "_sum ") &&
+         put_u64(buffer, size, &written, __atomic_load_n(&metric->sum, __ATOMIC_RELAXED)) &&
+         put_text(buffer, size, &written, "\n") &&
+         put_text(buffer, size, &written, family) &&
+         put_text(buffer, size, &written, "_count ") &&
+         put_u64(buffer, size, &written, cumulative) &&
+         put_text(buffer, size, &written, "\n");
+    return ok ? written : 0;
+}
+
+static bool put_text(char* buffer, size_t size, size_t* written, const char* text) {
+    size_t length = strlen(text);
+    if (*written + length > size) {
+        return false;
+    }
+    memcpy(buffer + *written, text, length);
+    *written += length;
+    return true;
+}
+
+static bool put_u64(char* buffer, size_t size, size_t* written, uint64_t value) {
+    char digits[20];
+    size_t length = payload_format_u64(digits, value);
+    if (*written + length > size) {
+        return false;
+    }
+    memcpy(buffer + *written, digits, length);
+    *written += length;
+    return true;
+}
+
+static void send_response(void) {
+    while (state.sent < state.length) {
+        // MSG_NOSIGNAL: a scraper that went away must not raise SIGPIPE
+        ssize_t length = send(client_fd, response + state.sent, state.length - state.sent, MSG_NOSIGNAL);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                close_client();
+            }
+            return;  // Socket full: wait for EPOLLOUT
+        }
+        state.sent += (size_t)length;
+    }
+    close_client();
+}
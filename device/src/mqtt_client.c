@@ -5,19 +5,24 @@
  * @date 2025-09-10
  */
 
-#define _DEFAULT_SOURCE  // Pour usleep()
 #include "mqtt_client.h"
+#include "payload_codec.h"
+#include "schedule.h"
+#include "probes.h"
 #include <signal.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <stdarg.h>
-#include <unistd.h>  // Pour usleep()
 #ifdef SIMULATION_MODE
     // Simulation mode - no real MQTT
     typedef struct { int dummy; } mosquitto;
     #define MOSQ_ERR_SUCCESS 0
     #define MOSQ_ERR_NO_CONN 1
     #define MOSQ_ERR_EAGAIN 2
+    #define MOSQ_ERR_INVAL 3
+    static void (*sim_on_connect)(struct mosquitto*, void*, int) = NULL;
+    static void (*sim_on_publish)(struct mosquitto*, void*, int) = NULL;
+    static int sim_next_mid = 0;
     static int sim_mosquitto_lib_init(void) { return 0; }
     static struct mosquitto* sim_mosquitto_new(const char* id, bool clean, void* obj) { (void)id; (void)clean; (void)obj; return (struct mosquitto*)malloc(sizeof(int)); }
     static void sim_mosquitto_lib_cleanup(void) {}
@@ -25,18 +30,19 @@
     static int sim_mosquitto_username_pw_set(struct mosquitto* mosq, const char* user, const char* pass) { (void)mosq; (void)user; (void)pass; return 0; }
     static int sim_mosquitto_tls_set(struct mosquitto* mosq, const char* ca, const char* cert, const char* key, const char* pwd, int (*verify)(int, void*)) { (void)mosq; (void)ca; (void)cert; (void)key; (void)pwd; (void)verify; return 0; }
     static int sim_mosquitto_tls_opts_set(struct mosquitto* mosq, int verify, const char* version, const char* ciphers) { (void)mosq; (void)verify; (void)version; (void)ciphers; return 0; }
-    static void sim_mosquitto_connect_callback_set(struct mosquitto* mosq, void (*cb)(struct mosquitto*, void*, int)) { (void)mosq; (void)cb; }
+    static void sim_mosquitto_connect_callback_set(struct mosquitto* mosq, void (*cb)(struct mosquitto*, void*, int)) { (void)mosq; sim_on_connect = cb; }
     static void sim_mosquitto_disconnect_callback_set(struct mosquitto* mosq, void (*cb)(struct mosquitto*, void*, int)) { (void)mosq; (void)cb; }
-    static void sim_mosquitto_publish_callback_set(struct mosquitto* mosq, void (*cb)(struct mosquitto*, void*, int)) { (void)mosq; (void)cb; }
+    static void sim_mosquitto_publish_callback_set(struct mosquitto* mosq, void (*cb)(struct mosquitto*, void*, int)) { (void)mosq; sim_on_publish = cb; }
     static void sim_mosquitto_log_callback_set(struct mosquitto* mosq, void (*cb)(struct mosquitto*, void*, int, const char*)) { (void)mosq; (void)cb; }
     static int sim_mosquitto_opts_set(struct mosquitto* mosq, int opt, void* val) { (void)mosq; (void)opt; (void)val; return 0; }
-    static int sim_mosquitto_connect_async(struct mosquitto* mosq, const char* host, int port, int keepalive) { (void)mosq; (void)host; (void)port; (void)keepalive; return 0; }
-    static int sim_mosquitto_loop_start(struct mosquitto* mosq) { (void)mosq; return 0; }
+    static int sim_mosquitto_connect_async(struct mosquitto* mosq, const char* host, int port, int keepalive) { (void)host; (void)port; (void)keepalive; if(sim_on_connect) sim_on_connect(mosq, NULL, 0); return 0; }
     static int sim_mosquitto_loop_misc(struct mosquitto* mosq) { (void)mosq; return 0; }
+    static int sim_mosquitto_loop_read(struct mosquitto* mosq, int max_packets) { (void)mosq; (void)max_packets; return 0; }
+    static int sim_mosquitto_loop_write(struct mosquitto* mosq, int max_packets) { (void)mosq; (void)max_packets; return 0; }
+    static int sim_mosquitto_socket(struct mosquitto* mosq) { (void)mosq; return -1; }
+    static bool sim_mosquitto_want_write(struct mosquitto* mosq) { (void)mosq; return false; }
     static int sim_mosquitto_disconnect(struct mosquitto* mosq) { (void)mosq; return 0; }
-    static void sim_mosquitto_loop_stop(struct mosquitto* mosq, bool force) { (void)mosq; (void)force; }
-    static int sim_mosquitto_publish(struct mosquitto* mosq, int* mid, const char* topic, int payloadlen, const void* payload, int qos, bool retain) { (void)mosq; (void)topic; (void)payloadlen; (void)payload; (void)qos; (void)retain; if(mid) *mid = 1; return 0; }
-    static int sim_mosquitto_loop(struct mosquitto* mosq, int timeout, int max_packets) { (void)mosq; (void)timeout; (void)max_packets; return 0; }
+    static int sim_mosquitto_publish(struct mosquitto* mosq, int* mid, const char* topic, int payloadlen, const void* payload, int qos, bool retain) { (void)topic; (void)payloadlen; (void)payload; (void)qos; (void)retain; int id = ++sim_next_mid; if(mid) *mid = id; if(sim_on_publish) sim_on_publish(mosq, NULL, id); return 0; }
     static const char* sim_mosquitto_strerror(int mosq_errno) { (void)mosq_errno; return "Simulation mode"; }
 
     // Map function names
@@ -53,12 +59,13 @@
     #define mosquitto_log_callback_set sim_mosquitto_log_callback_set
     #define mosquitto_opts_set sim_mosquitto_opts_set
     #define mosquitto_connect_async sim_mosquitto_connect_async
-    #define mosquitto_loop_start sim_mosquitto_loop_start
     #define mosquitto_loop_misc sim_mosquitto_loop_misc
+    #define mosquitto_loop_read sim_mosquitto_loop_read
+    #define mosquitto_loop_write sim_mosquitto_loop_write
+    #define mosquitto_socket sim_mosquitto_socket
+    #define mosquitto_want_write sim_mosquitto_want_write
     #define mosquitto_disconnect sim_mosquitto_disconnect
-    #define mosquitto_loop_stop sim_mosquitto_loop_stop
     #define mosquitto_publish sim_mosquitto_publish
-    #define mosquitto_loop sim_mosquitto_loop
     #define mosquitto_strerror sim_mosquitto_strerror
     
     // Some missing constants
@@ -75,11 +82,22 @@
 
 // Internal state
 static struct mosquitto* mosq = NULL;
-static bool connected = false;
+static bool connected = false;                 // __atomic accesses: mqtt_is_connected() may run on other threads
 static bool initialized = false;
 static char last_error[512] = "";
 static mqtt_config_t current_config;
-static volatile bool connection_in_progress = false;
+static bool connection_in_progress = false;    // __atomic accesses, like connected
+static mqtt_publish_cb_t publish_callback = NULL;
+
+// Publish-to-acknowledgement latency: send time of the messages in flight by mid
+#define MQTT_LATENCY_SLOTS 64
+typedef struct {
+    int mid;
+    uint64_t sent_us;          // 0 = slot free
+} publish_time_t;
+static publish_time_t publish_times[MQTT_LATENCY_SLOTS];
+static uint64_t publish_started_us = 0;        // Inside mosquitto_publish(): QoS 0 may complete there
+static metric_t* ack_latency_metric = NULL;
 
 // Internal helper functions
 static void on_connect(struct mosquitto* mosq, void* obj, int result);
@@ -89,6 +107,8 @@ static void on_log(struct mosquitto* mosq, void* obj, int level, const char* str
 static void set_error(const char* format, ...);
 static const char* connection_result_to_string(int result);
 static int validate_config(const mqtt_config_t* config);
+static int publish_timed(const char* topic, int length, const void* payload, int* mid);
+static void record_ack_latency(int mid);
 
 /**
  * Initialize MQTT client
@@ -104,6 +124,10 @@ int mqtt_init(const mqtt_config_t* config) {
         return result;
     }
     
+    ack_latency_metric = metric_register("techtemp_mqtt_publish_ack_latency_us",
+                                         "Publish to PUBACK (QoS 1) or socket write (QoS 0) latency",
+                                         METRIC_HISTOGRAM);
+    
     LOG_DEBUG_F("Initializing MQTT client");
     LOG_DEBUG_F("Broker: %s:%d", config->host, config->port);
     LOG_DEBUG_F("Client ID: %s", config->client_id);
@@ -180,54 +204,65 @@ int mqtt_connect(void) {
         return TECHTEMP_ERROR;
     }
     
-    if (connected) {
+    if (__atomic_load_n(&connected, __ATOMIC_ACQUIRE)) {
         LOG_DEBUG_F("MQTT already connected");
         return TECHTEMP_OK;
     }
     
-    if (connection_in_progress) {
+    if (__atomic_load_n(&connection_in_progress, __ATOMIC_ACQUIRE)) {
         set_error("Connection already in progress");
         return TECHTEMP_ERROR;
     }
     
     LOG_INFO_F("Connecting to MQTT broker %s:%d", current_config.host, current_config.port);
-    connection_in_progress = true;
+    __atomic_store_n(&connection_in_progress, true, __ATOMIC_RELEASE);
     
+    // Non-blocking: the CONNECT packet is written and the CONNACK read by
+    // the event loop (mqtt_handle_events); a previous socket is closed first
+    TECHTEMP_PROBE2(connect_start, current_config.host, current_config.port);
     int result = mosquitto_connect_async(mosq, current_config.host, current_config.port, current_config.keepalive);
+    TECHTEMP_PROBE1(connect_done, result);
     if (result != MOSQ_ERR_SUCCESS) {
-        connection_in_progress = false;
+        __atomic_store_n(&connection_in_progress, false, __ATOMIC_RELEASE);
         set_error("Failed to connect to MQTT broker: %s", mosquitto_strerror(result));
         return TECHTEMP_ERROR;
     }
     
-    // Start network loop
-    result = mosquitto_loop_start(mosq);
-    if (result != MOSQ_ERR_SUCCESS) {
-        connection_in_progress = false;
-        set_error("Failed to start MQTT network loop: %s", mosquitto_strerror(result));
-        return TECHTEMP_ERROR;
-    }
-    
-    // Wait for connection to complete
-    int timeout = current_config.connect_timeout_ms / 100; // 100ms intervals
-    while (timeout-- > 0 && connection_in_progress) {
-        usleep(100000); // 100ms
-        mosquitto_loop_misc(mosq);
-    }
-    
-    if (connection_in_progress) {
-        connection_in_progress = false;
+    return TECHTEMP_OK;
+}
+
+/**
+ * Check if a connection attempt is waiting for the broker
+ */
+bool mqtt_is_connecting(void) {
+    return __atomic_load_n(&connection_in_progress, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Give up on the current connection attempt
+ */
+void mqtt_abort_connect(void) {
+    // The half-open socket is closed by the next mqtt_connect()
+    if (__atomic_load_n(&connection_in_progress, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&connection_in_progress, false, __ATOMIC_RELEASE);
         set_error("Timeout connecting to MQTT broker");
-        return TECHTEMP_TIMEOUT;
     }
-    
-    if (!connected) {
-        set_error("Failed to establish MQTT connection");
+}
+
+/**
+ * Recreate the libmosquitto client with the current configuration
+ */
+int mqtt_reinit(void) {
+    if (!initialized) {
+        set_error("MQTT client not initialized");
         return TECHTEMP_ERROR;
     }
     
-    LOG_INFO_F("Connected to MQTT broker successfully");
-    return TECHTEMP_OK;
+    mqtt_config_t config;
+    memcpy(&config, &current_config, sizeof(config));
+    
+    mqtt_cleanup();
+    return mqtt_init(&config);
 }
 
 /**
@@ -238,7 +273,7 @@ int mqtt_disconnect(void) {
         return TECHTEMP_OK;
     }
     
-    if (!connected) {
+    if (!__atomic_load_n(&connected, __ATOMIC_ACQUIRE)) {
         LOG_DEBUG_F("MQTT already disconnected");
         return TECHTEMP_OK;
     }
@@ -251,28 +286,28 @@ int mqtt_disconnect(void) {
         return TECHTEMP_ERROR;
     }
     
-    // Stop network loop
-    mosquitto_loop_stop(mosq, true);
-    
-    connected = false;
+    __atomic_store_n(&connected, false, __ATOMIC_RELEASE);
     return TECHTEMP_OK;
 }
 
 /**
  * Publish sensor reading to MQTT
  */
-int mqtt_publish_reading(const sensor_reading_t* reading, const char* device_uid) {
-    if (!reading || !device_uid) {
-        set_error("Reading or device UID pointer is null");
+int mqtt_publish_reading(const sensor_reading_t* reading, const char* topic, int* mid_out) {
+    if (!reading) {
+        set_error("Reading pointer is null");
         return TECHTEMP_ERROR;
     }
+    if (!topic) {
+        topic = current_config.topic;
+    }
     
     if (!initialized) {
         set_error("MQTT client not initialized");
         return TECHTEMP_ERROR;
     }
     
-    if (!connected) {
+    if (!__atomic_load_n(&connected, __ATOMIC_ACQUIRE)) {
         set_error("MQTT client not connected");
         return TECHTEMP_ERROR;
     }
@@ -282,64 +317,260 @@ int mqtt_publish_reading(const sensor_reading_t* reading, const char* device_uid
         return TECHTEMP_ERROR;
     }
     
-    // Create JSON payload - Backend expects: temperature_c, humidity_pct, ts
-    char payload[512];
-    int written = snprintf(payload, sizeof(payload),
-        "{"
-        "\"temperature_c\":%.2f,"
-        "\"humidity_pct\":%.2f,"
-        "\"ts\":%lu"
-        "}",
-        reading->temperature,
-        reading->humidity,
-        (unsigned long)reading->timestamp
-    );
+    // Stack buffer, integer-only encoders: no heap, no printf on this path
+    char payload[PAYLOAD_READING_JSON_MAX];
+    int written;
+    if (current_config.payload_format == PAYLOAD_FORMAT_BINARY) {
+        written = payload_encode_binary((uint8_t*)payload, sizeof(payload), reading, 1);
+    } else {
+        // JSON payload - Backend expects: temperature_c, humidity_pct, ts
+        written = payload_encode_json(payload, sizeof(payload), reading);
+    }
     
-    if (written >= (int)sizeof(payload)) {
+    if (written < 0) {
         set_error("MQTT payload too large");
         return TECHTEMP_ERROR;
     }
     
-    LOG_DEBUG_F("Publishing to topic '%s': %s", current_config.topic, payload);
+    if (log_get_level() == LOG_LEVEL_DEBUG) {
+        if (current_config.payload_format == PAYLOAD_FORMAT_BINARY) {
+            LOG_DEBUG_F("Publishing to topic '%s': %d bytes (binary, seq %llu)",
+                        topic, written, (unsigned long long)reading->seq);
+        } else {
+            LOG_DEBUG_F("Publishing to topic '%s': %.*s", topic, written, payload);
+        }
+    }
     
     // Publish message
     int mid;
-    int result = mosquitto_publish(mosq, &mid, current_config.topic, written, payload, current_config.qos, false);
+    int result = publish_timed(topic, written, payload, &mid);
     if (result != MOSQ_ERR_SUCCESS) {
         set_error("Failed to publish MQTT message: %s", mosquitto_strerror(result));
         return TECHTEMP_ERROR;
     }
     
     LOG_DEBUG_F("Message published with ID: %d", mid);
+    if (mid_out) {
+        *mid_out = mid;
+    }
+    return TECHTEMP_OK;
+}
+
+/**
+ * Publish several readings as one JSON array on the batch topic
+ */
+int mqtt_publish_batch(const sensor_reading_t* readings, int count, const char* topic, int* mid_out) {
+    static char payload[MQTT_BATCH_MAX_READINGS * (PAYLOAD_READING_JSON_MAX + 1) + 2];
+    
+    if (!readings || count <= 0 || count > MQTT_BATCH_MAX_READINGS) {
+        set_error("Invalid batch (%d readings)", count);
+        return TECHTEMP_ERROR;
+    }
+    if (!topic) {
+        topic = current_config.batch_topic;
+    }
+    
+    if (!initialized) {
+        set_error("MQTT client not initialized");
+        return TECHTEMP_ERROR;
+    }
+    
+    if (!__atomic_load_n(&connected, __ATOMIC_ACQUIRE)) {
+        set_error("MQTT client not connected");
+        return TECHTEMP_ERROR;
+    }
+    
+    size_t written = 0;
+    if (current_config.payload_format == PAYLOAD_FORMAT_BINARY) {
+        int len = payload_encode_binary((uint8_t*)payload, sizeof(payload), readings, count);
+        if (len < 0) {
+            set_error("MQTT batch payload too large");
+            return TECHTEMP_ERROR;
+        }
+        written = (size_t)len;
+    } else {
+        // [{...},{...}] - same object layout as single readings
+        payload[written++] = '[';
+        for (int i = 0; i < count; i++) {
+            if (i > 0) {
+                payload[written++] = ',';
+            }
+            int len = payload_encode_json(payload + written, sizeof(payload) - written - 1, &readings[i]);
+            if (len < 0) {
+                set_error("MQTT batch payload too large");
+                return TECHTEMP_ERROR;
+            }
+            written += (size_t)len;
+        }
+        payload[written++] = ']';
+    }
+    
+    LOG_DEBUG_F("Publishing %d readings to topic '%s' (%zu bytes)", count, topic, written);
+    
+    int mid;
+    int result = publish_timed(topic, (int)written, payload, &mid);
+    if (result != MOSQ_ERR_SUCCESS) {
+        set_error("Failed to publish MQTT batch: %s", mosquitto_strerror(result));
+        return TECHTEMP_ERROR;
+    }
+    
+    if (mid_out) {
+        *mid_out = mid;
+    }
+    return TECHTEMP_OK;
+}
+
+/**
+ * Publish a closed aggregation bucket
+ */
+int mqtt_publish_aggregate(const aggregate_bucket_t* bucket, const char* topic, int* mid_out) {
+    if (!bucket || !topic || bucket->count == 0) {
+        set_error("Invalid aggregate");
+        return TECHTEMP_ERROR;
+    }
+    
+    if (!initialized) {
+        set_error("MQTT client not initialized");
+        return TECHTEMP_ERROR;
+    }
+    
+    if (!__atomic_load_n(&connected, __ATOMIC_ACQUIRE)) {
+        set_error("MQTT client not connected");
+        return TECHTEMP_ERROR;
+    }
+    
+    char payload[PAYLOAD_AGGREGATE_JSON_MAX];
+    int written = payload_encode_aggregate_json(payload, sizeof(payload), bucket);
+    if (written < 0) {
+        set_error("MQTT aggregate payload too large");
+        return TECHTEMP_ERROR;
+    }
+    
+    LOG_DEBUG_F("Publishing to topic '%s': %.*s", topic, written, payload);
+    
+    int mid;
+    int result = publish_timed(topic, written, payload, &mid);
+    if (result != MOSQ_ERR_SUCCESS) {
+        set_error("Failed to publish MQTT aggregate: %s", mosquitto_strerror(result));
+        return TECHTEMP_ERROR;
+    }
+    
+    if (mid_out) {
+        *mid_out = mid;
+    }
     return TECHTEMP_OK;
 }
 
+/**
+ * Publish a self-telemetry snapshot
+ */
+int mqtt_publish_stats(const device_stats_t* stats, const char* topic) {
+    if (!stats || !topic) {
+        set_error("Invalid stats");
+        return TECHTEMP_ERROR;
+    }
+    
+    if (!initialized) {
+        set_error("MQTT client not initialized");
+        return TECHTEMP_ERROR;
+    }
+    
+    if (!__atomic_load_n(&connected, __ATOMIC_ACQUIRE)) {
+        set_error("MQTT client not connected");
+        return TECHTEMP_ERROR;
+    }
+    
+    char payload[PAYLOAD_STATS_JSON_MAX];
+    int written = payload_encode_stats_json(payload, sizeof(payload), stats);
+    if (written < 0) {
+        set_error("MQTT stats payload too large");
+        return TECHTEMP_ERROR;
+    }
+    
+    LOG_DEBUG_F("Publishing to topic '%s': %.*s", topic, written, payload);
+    
+    // Not timed: snapshots would skew the publish latency they report
+    int mid;
+    int result = mosquitto_publish(mosq, &mid, topic, written, payload, current_config.qos, false);
+    if (result != MOSQ_ERR_SUCCESS) {
+        set_error("Failed to publish MQTT stats: %s", mosquitto_strerror(result));
+        return TECHTEMP_ERROR;
+    }
+    return TECHTEMP_OK;
+}
+
+/**
+ * Register the publish acknowledgement callback
+ */
+void mqtt_set_publish_callback(mqtt_publish_cb_t callback) {
+    publish_callback = callback;
+}
+
 /**
  * Check if MQTT client is connected
  */
 bool mqtt_is_connected(void) {
-    return connected;
+    return __atomic_load_n(&connected, __ATOMIC_ACQUIRE);
 }
 
 /**
- * Process MQTT network events
+ * Get MQTT socket for the event loop
  */
-int mqtt_loop(int timeout_ms) {
+int mqtt_get_socket(void) {
+    if (!initialized) {
+        return -1;
+    }
+    return mosquitto_socket(mosq);
+}
+
+/**
+ * Check if outgoing data is waiting for the socket
+ */
+bool mqtt_want_write(void) {
+    if (!initialized) {
+        return false;
+    }
+    return mosquitto_want_write(mosq);
+}
+
+/**
+ * Handle socket events reported by the event loop
+ */
+int mqtt_handle_events(bool readable, bool writable) {
     if (!initialized) {
         return TECHTEMP_ERROR;
     }
     
-    int result = mosquitto_loop(mosq, timeout_ms, 1);
+    int result = MOSQ_ERR_SUCCESS;
+    if (readable) {
+        result = mosquitto_loop_read(mosq, 1);
+    }
+    if (result == MOSQ_ERR_SUCCESS && writable) {
+        result = mosquitto_loop_write(mosq, 1);
+    }
+    
     if (result != MOSQ_ERR_SUCCESS) {
-        if (result == MOSQ_ERR_NO_CONN) {
-            connected = false;
-            return TECHTEMP_ERROR;
-        }
-        // Skip non-critical errors
-        if (result != MOSQ_ERR_INVAL) {
-            set_error("MQTT loop error: %s", mosquitto_strerror(result));
-            return TECHTEMP_ERROR;
-        }
+        __atomic_store_n(&connected, false, __ATOMIC_RELEASE);
+        __atomic_store_n(&connection_in_progress, false, __ATOMIC_RELEASE);
+        set_error("MQTT network error: %s", mosquitto_strerror(result));
+        return TECHTEMP_ERROR;
+    }
+    
+    return TECHTEMP_OK;
+}
+
+/**
+ * Run periodic MQTT housekeeping (keepalive pings, retries)
+ */
+int mqtt_handle_misc(void) {
+    if (!initialized) {
+        return TECHTEMP_ERROR;
+    }
+    
+    int result = mosquitto_loop_misc(mosq);
+    if (result != MOSQ_ERR_SUCCESS) {
+        __atomic_store_n(&connected, false, __ATOMIC_RELEASE);
+        return TECHTEMP_ERROR;
     }
     
     return TECHTEMP_OK;
@@ -352,7 +583,7 @@ void mqtt_cleanup(void) {
     if (initialized) {
         LOG_DEBUG_F("Cleaning up MQTT resources");
         
-        if (connected) {
+        if (__atomic_load_n(&connected, __ATOMIC_ACQUIRE)) {
             mqtt_disconnect();
         }
         
@@ -364,8 +595,8 @@ void mqtt_cleanup(void) {
         mosquitto_lib_cleanup();
         
         initialized = false;
-        connected = false;
-        connection_in_progress = false;
+        __atomic_store_n(&connected, false, __ATOMIC_RELEASE);
+        __atomic_store_n(&connection_in_progress, false, __ATOMIC_RELEASE);
     }
 }
 
@@ -382,13 +613,15 @@ static void on_connect(struct mosquitto* mosq, void* obj, int result) {
     (void)mosq;
     (void)obj;
     
-    connection_in_progress = false;
+    __atomic_store_n(&connection_in_progress, false, __ATOMIC_RELEASE);
+    TECHTEMP_PROBE1(connected, result);
     
     if (result == 0) {
-        connected = true;
+        __atomic_store_n(&connected, true, __ATOMIC_RELEASE);
         LOG_INFO_F("MQTT connection established");
     } else {
-        connected = false;
+        __atomic_store_n(&connected, false, __ATOMIC_RELEASE);
+        set_error("%s", connection_result_to_string(result));
         LOG_ERROR_F("MQTT connection failed: %s", connection_result_to_string(result));
     }
 }
@@ -397,8 +630,9 @@ static void on_disconnect(struct mosquitto* mosq, void* obj, int result) {
     (void)mosq;
     (void)obj;
     
-    connected = false;
-    connection_in_progress = false;
+    __atomic_store_n(&connected, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&connection_in_progress, false, __ATOMIC_RELEASE);
+    TECHTEMP_PROBE1(disconnected, result);
     
     if (result == 0) {
         LOG_INFO_F("MQTT disconnected normally");
@@ -412,6 +646,12 @@ static void on_publish(struct mosquitto* mosq, void* obj, int mid) {
     (void)obj;
     
     LOG_DEBUG_F("MQTT message %d published successfully", mid);
+    TECHTEMP_PROBE1(publish_ack, mid);
+    record_ack_latency(mid);
+    
+    if (publish_callback) {
+        publish_callback(mid);
+    }
 }
 
 static void on_log(struct mosquitto* mosq, void* obj, int level, const char* str) {
@@ -504,3 +744,32 @@ static int validate_config(const mqtt_config_t* config) {
     
     return TECHTEMP_OK;
 }
+
+static int publish_timed(const char* topic, int length, const void* payload, int* mid) {
+    TECHTEMP_PROBE2(publish_start, topic, length);
+    publish_started_us = schedule_monotonic_us();
+    int result = mosquitto_publish(mosq, mid, topic, length, payload, current_config.qos, false);
+    TECHTEMP_PROBE3(publish_done, result == MOSQ_ERR_SUCCESS ? *mid : -1, length, result);
+    
+    // Not completed during the call: remember when it was sent
+    if (result == MOSQ_ERR_SUCCESS && publish_started_us != 0) {
+        publish_times[*mid % MQTT_LATENCY_SLOTS] = (publish_time_t){ .mid = *mid, .sent_us = publish_started_us };
+    }
+    publish_started_us = 0;
+    return result;
+}
+
+static void record_ack_latency(int mid) {
+    uint64_t now_us = schedule_monotonic_us();
+    
+    // Slot reused by a later mid (more than MQTT_LATENCY_SLOTS in flight): not measured
+    publish_time_t* slot = &publish_times[mid % MQTT_LATENCY_SLOTS];
+    if (slot->mid == mid && slot->sent_us != 0) {
+        metric_observe(ack_latency_metric, now_us - slot->sent_us);
+        slot->sent_us = 0;
+    } else if (publish_started_us != 0) {
+        // Completed inside mosquitto_publish(): the message being sent
+        metric_observe(ack_latency_metric, now_us - publish_started_us);
+        publish_started_us = 0;
+    }
+}
@@ -0,0 +1,224 @@
+/**
+ * @file payload_codec.c
+ * @brief MQTT payload encoders implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#include "payload_codec.h"
+
+// Constant JSON fragments (lengths known at compile time)
+#define FRAGMENT(s) { s, sizeof(s) - 1 }
+typedef struct {
+    const char* text;
+    size_t length;
+} fragment_t;
+
+static const fragment_t JSON_TEMPERATURE = FRAGMENT("{\"temperature_c\":");
+static const fragment_t JSON_HUMIDITY = FRAGMENT(",\"humidity_pct\":");
+static const fragment_t JSON_TIMESTAMP = FRAGMENT(",\"ts\":");
+static const fragment_t JSON_END = FRAGMENT("}");
+static const fragment_t JSON_AGGREGATE_TIMESTAMP = FRAGMENT("{\"ts\":");
+static const fragment_t JSON_AGGREGATE_WINDOW = FRAGMENT(",\"window_s\":");
+static const fragment_t JSON_AGGREGATE_COUNT = FRAGMENT(",\"count\":");
+static const fragment_t JSON_AGGREGATE_TEMPERATURE = FRAGMENT(",\"temperature_c\":");
+static const fragment_t JSON_AGGREGATE_TEMPERATURE_MIN = FRAGMENT(",\"temperature_min_c\":");
+static const fragment_t JSON_AGGREGATE_TEMPERATURE_MAX = FRAGMENT(",\"temperature_max_c\":");
+static const fragment_t JSON_AGGREGATE_HUMIDITY = FRAGMENT(",\"humidity_pct\":");
+static const fragment_t JSON_AGGREGATE_HUMIDITY_MIN = FRAGMENT(",\"humidity_min_pct\":");
+static const fragment_t JSON_AGGREGATE_HUMIDITY_MAX = FRAGMENT(",\"humidity_max_pct\":");
+
+// Stats object: one fragment per field, in device_stats_t order
+static const fragment_t JSON_STATS_FIELDS[] = {
+    FRAGMENT("{\"ts\":"),
+    FRAGMENT(",\"uptime_s\":"),
+    FRAGMENT(",\"readings\":"),
+    FRAGMENT(",\"published\":"),
+    FRAGMENT(",\"suppressed\":"),
+    FRAGMENT(",\"dropped\":"),
+    FRAGMENT(",\"publish_latency_p50_us\":"),
+    FRAGMENT(",\"publish_latency_p99_us\":"),
+    FRAGMENT(",\"i2c_errors\":"),
+    FRAGMENT(",\"reconnects\":"),
+    FRAGMENT(",\"rss_kb\":"),
+    FRAGMENT(",\"cpu_ms\":"),
+    FRAGMENT(",\"queue_depth\":")
+};
+
+// Internal helper functions
+static size_t put_fragment(char* buffer, const fragment_t* fragment);
+static size_t put_varint(uint8_t* buffer, uint64_t value);
+static uint16_t to_i16_bits(int32_t value);
+
+/**
+ * Encode one reading as a JSON object
+ */
+int payload_encode_json(char* buffer, size_t size, const sensor_reading_t* reading) {
+    if (size < PAYLOAD_READING_JSON_MAX) {
+        return -1;
+    }
+    
+    size_t written = put_fragment(buffer, &JSON_TEMPERATURE);
+    written += payload_format_centi(buffer + written, reading->temperature_centi);
+    written += put_fragment(buffer + written, &JSON_HUMIDITY);
+    written += payload_format_centi(buffer + written, reading->humidity_centi);
+    written += put_fragment(buffer + written, &JSON_TIMESTAMP);
+    written += payload_format_u64(buffer + written, reading->timestamp);
+    written += put_fragment(buffer + written, &JSON_END);
+    
+    return (int)written;
+}
+
+/**
+ * Encode a closed aggregation bucket as a JSON object
+ */
+int payload_encode_aggregate_json(char* buffer, size_t size, const aggregate_bucket_t* bucket) {
+    if (size < PAYLOAD_AGGREGATE_JSON_MAX) {
+        return -1;
+    }
+    
+    size_t written = put_fragment(buffer, &JSON_AGGREGATE_TIMESTAMP);
+    written += payload_format_u64(buffer + written, bucket->start_ms);
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_WINDOW);
+    written += payload_format_u64(buffer + written, bucket->window_s);
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_COUNT);
+    written += payload_format_u64(buffer + written, bucket->count);
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_TEMPERATURE);
+    written += payload_format_centi(buffer + written, aggregate_mean_centi(&bucket->temperature, bucket->count));
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_TEMPERATURE_MIN);
+    written += payload_format_centi(buffer + written, bucket->temperature.min);
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_TEMPERATURE_MAX);
+    written += payload_format_centi(buffer + written, bucket->temperature.max);
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_HUMIDITY);
+    written += payload_format_centi(buffer + written, aggregate_mean_centi(&bucket->humidity, bucket->count));
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_HUMIDITY_MIN);
+    written += payload_format_centi(buffer + written, bucket->humidity.min);
+    written += put_fragment(buffer + written, &JSON_AGGREGATE_HUMIDITY_MAX);
+    written += payload_format_centi(buffer + written, bucket->humidity.max);
+    written += put_fragment(buffer + written, &JSON_END);
+    
+    return (int)written;
+}
+
+/**
+ * Encode a stats snapshot as a JSON object
+ */
+int payload_encode_stats_json(char* buffer, size_t size, const device_stats_t* stats) {
+    if (size < PAYLOAD_STATS_JSON_MAX) {
+        return -1;
+    }
+    
+    const uint64_t values[] = {
+        stats->timestamp, stats->uptime_s, stats->readings, stats->published, stats->suppressed,
+        stats->dropped, stats->publish_latency_p50_us, stats->publish_latency_p99_us, stats->i2c_errors,
+        stats->reconnects, stats->rss_kb, stats->cpu_ms, stats->queue_depth
+    };
+    
+    size_t written = 0;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        written += put_fragment(buffer + written, &JSON_STATS_FIELDS[i]);
+        written += payload_format_u64(buffer + written, values[i]);
+    }
+    written += put_fragment(buffer + written, &JSON_END);
+    
+    return (int)written;
+}
+
+/**
+ * Encode consecutive readings as one binary payload
+ */
+int payload_encode_binary(uint8_t* buffer, size_t size, const sensor_reading_t* readings, int count) {
+    if (count <= 0 || size < PAYLOAD_BINARY_HEADER_MAX + (size_t)count * PAYLOAD_READING_BINARY_MAX) {
+        return -1;
+    }
+    
+    size_t written = 0;
+    buffer[written++] = PAYLOAD_BINARY_VERSION;
+    written += put_varint(buffer + written, (uint64_t)count);
+    written += put_varint(buffer + written, readings[0].seq);
+    written += put_varint(buffer + written, readings[0].timestamp);
+    
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            // Zigzag keeps a backwards clock step small and valid
+            int64_t delta = (int64_t)(readings[i].timestamp - readings[i - 1].timestamp);
+            written += put_varint(buffer + written, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        }
+        
+        uint16_t temperature = to_i16_bits(readings[i].temperature_centi);
+        uint16_t humidity = to_i16_bits(readings[i].humidity_centi);
+        buffer[written++] = (uint8_t)(temperature & 0xFF);
+        buffer[written++] = (uint8_t)(temperature >> 8);
+        buffer[written++] = (uint8_t)(humidity & 0xFF);
+        buffer[written++] = (uint8_t)(humidity >> 8);
+    }
+    
+    return (int)written;
+}
+
+/**
+ * Write a fixed-point hundredths value as a decimal
+ */
+size_t payload_format_centi(char* buffer, int32_t centi) {
+    size_t written = 0;
+    uint32_t magnitude = (uint32_t)centi;
+    if (centi < 0) {
+        buffer[written++] = '-';
+        magnitude = 0u - magnitude;
+    }
+    
+    written += payload_format_u64(buffer + written, magnitude / 100);
+    uint32_t fraction = magnitude % 100;
+    buffer[written++] = '.';
+    buffer[written++] = (char)('0' + fraction / 10);
+    buffer[written++] = (char)('0' + fraction % 10);
+    return written;
+}
+
+/**
+ * Write an unsigned integer in decimal
+ */
+size_t payload_format_u64(char* buffer, uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    
+    // Only the high digits need 64-bit divisions (slow libgcc calls on ARMv6)
+    while (value > UINT32_MAX) {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    uint32_t low = (uint32_t)value;
+    do {
+        digits[count++] = (char)('0' + low % 10);
+        low /= 10;
+    } while (low != 0);
+    
+    for (size_t i = 0; i < count; i++) {
+        buffer[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+// Internal helper functions
+
+static size_t put_fragment(char* buffer, const fragment_t* fragment) {
+    memcpy(buffer, fragment->text, fragment->length);
+    return fragment->length;
+}
+
+static size_t put_varint(uint8_t* buffer, uint64_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+    return length;
+}
+
+static uint16_t to_i16_bits(int32_t value) {
+    // Saturate to the int16 range (±327.67 is far outside the sensor range)
+    if (value > INT16_MAX) value = INT16_MAX;
+    if (value < INT16_MIN) value = INT16_MIN;
+    return (uint16_t)(int16_t)value;
+}
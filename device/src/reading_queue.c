@@ -0,0 +1,419 @@
+/**
+ * @file reading_queue.c
+ * @brief Persistent store-and-forward queue implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * File layout: one 64-byte header followed by `capacity` 32-byte records.
+ * Record n lives in slot (n % capacity). A record is written completely
+ * (with its sequence number and checksum) before head_seq is advanced,
+ * so a torn append is detected and discarded on recovery.
+ */
+
+#define _DEFAULT_SOURCE  // Pour MAP_ANONYMOUS
+#include "reading_queue.h"
+#include <stddef.h>
+#include <math.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// On-disk header (64 bytes)
+typedef struct queue_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;       // Number of record slots
+    uint32_t record_size;    // sizeof(queue_record_t)
+    uint64_t head_seq;       // Sequence number of the next append
+    uint64_t tail_seq;       // Oldest unacknowledged record
+    uint64_t dropped;        // Records overwritten because the queue was full
+    uint8_t reserved[24];
+} queue_header_t;
+
+// On-disk record (32 bytes)
+typedef struct queue_record {
+    uint64_t seq;
+    uint64_t timestamp;
+    float temperature;
+    float humidity;
+    int16_t temperature_centi;  // Version 2 (zero in version 1 records)
+    int16_t humidity_centi;
+    uint32_t checksum;       // FNV-1a over the preceding fields
+} queue_record_t;
+
+// Shared by all queues (registered by the first reading_queue_open)
+static metric_t* dropped_metric = NULL;
+static metric_t* published_metric = NULL;
+
+// Internal helper functions
+static uint32_t record_checksum(const queue_record_t* record);
+static void sync_range(const reading_queue_t* queue, const void* addr, size_t length, int flags);
+static void init_header(reading_queue_t* queue, uint32_t capacity);
+static void recover(reading_queue_t* queue);
+static void migrate_v1(reading_queue_t* queue);
+static void retire_acked(reading_queue_t* queue);
+static void pop_inflight(reading_queue_t* queue);
+
+/**
+ * Open (or create) the queue file
+ */
+int reading_queue_open(reading_queue_t* queue, const char* path, uint32_t capacity) {
+    if (queue->mapping) {
+        return TECHTEMP_OK;
+    }
+    queue->fd = -1;
+    
+    if (!dropped_metric) {
+        dropped_metric = metric_register("techtemp_queue_dropped_total",
+                                         "Readings overwritten because a persistent queue was full",
+                                         METRIC_COUNTER);
+        published_metric = metric_register("techtemp_readings_published_total",
+                                           "Readings retired from a queue once acknowledged", METRIC_COUNTER);
+    }
+    
+    if (capacity == 0) {
+        capacity = READING_QUEUE_DEFAULT_CAPACITY;
+    }
+    
+    queue->mapping_size = sizeof(queue_header_t) + (size_t)capacity * sizeof(queue_record_t);
+    
+    if (!path || path[0] == '\0') {
+        // Memory-only queue: still bounded and ordered, but lost on restart
+        queue->mapping = mmap(NULL, queue->mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (queue->mapping == MAP_FAILED) {
+            queue->mapping = NULL;
+            LOG_ERROR_F("Failed to allocate reading queue: %s", strerror(errno));
+            return TECHTEMP_ERROR;
+        }
+        queue->header = (queue_header_t*)queue->mapping;
+        queue->records = (queue_record_t*)(queue->mapping + sizeof(queue_header_t));
+        init_header(queue, capacity);
+        LOG_INFO_F("Reading queue in memory (%u slots, not persistent)", capacity);
+        return TECHTEMP_OK;
+    }
+    
+    // Create parent directory if needed
+    char dir[MAX_STRING_LEN];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char* slash = strrchr(dir, '/');
+    if (slash && slash != dir) {
+        *slash = '\0';
+        create_directory(dir);
+    }
+    
+    queue->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (queue->fd < 0) {
+        LOG_ERROR_F("Failed to open reading queue %s: %s", path, strerror(errno));
+        return TECHTEMP_ERROR;
+    }
+    
+    struct stat st = {0};
+    bool existing = (fstat(queue->fd, &st) == 0 && (size_t)st.st_size >= sizeof(queue_header_t));
+    
+    if ((size_t)st.st_size != queue->mapping_size && ftruncate(queue->fd, (off_t)queue->mapping_size) != 0) {
+        LOG_ERROR_F("Failed to size reading queue %s: %s", path, strerror(errno));
+        close(queue->fd);
+        queue->fd = -1;
+        return TECHTEMP_ERROR;
+    }
+    
+    queue->mapping = mmap(NULL, queue->mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, queue->fd, 0);
+    if (queue->mapping == MAP_FAILED) {
+        queue->mapping = NULL;
+        LOG_ERROR_F("Failed to map reading queue %s: %s", path, strerror(errno));
+        close(queue->fd);
+        queue->fd = -1;
+        return TECHTEMP_ERROR;
+    }
+    
+    queue->header = (queue_header_t*)queue->mapping;
+    queue->records = (queue_record_t*)(queue->mapping + sizeof(queue_header_t));
+    
+    if (existing && queue->header->magic == READING_QUEUE_MAGIC &&
+        (queue->header->version == READING_QUEUE_VERSION || queue->header->version == 1) &&
+        queue->header->record_size == sizeof(queue_record_t) &&
+        queue->header->capacity == capacity) {
+        recover(queue);
+        if (queue->header->version == 1) {
+            migrate_v1(queue);
+        }
+        LOG_INFO_F("Reading queue %s recovered: %u readings pending", path, reading_queue_depth(queue));
+    } else {
+        if (existing && queue->header->magic == READING_QUEUE_MAGIC) {
+            LOG_WARN_F("Reading queue %s layout changed, starting empty", path);
+        }
+        init_header(queue, capacity);
+        sync_range(queue, queue->mapping, queue->mapping_size, MS_SYNC);
+        LOG_INFO_F("Reading queue %s created (%u slots)", path, capacity);
+    }
+    
+    return TECHTEMP_OK;
+}
+
+/**
+ * Append a reading
+ */
+int reading_queue_push(reading_queue_t* queue, const sensor_reading_t* reading) {
+    if (!queue->header || !reading) {
+        return TECHTEMP_ERROR;
+    }
+    
+    // Queue full: drop the oldest reading to make room
+    if (queue->header->head_seq - queue->header->tail_seq >= queue->header->capacity) {
+        if (queue->inflight_count > 0) {
+            // The oldest record belongs to the oldest in-flight message
+            if (--queue->inflight[queue->inflight_first].count == 0) {
+                pop_inflight(queue);
+            }
+        } else {
+            queue->send_seq++;
+        }
+        queue->header->tail_seq++;
+        queue->header->dropped++;
+        metric_inc(dropped_metric);
+    }
+    
+    queue_record_t* record = &queue->records[queue->header->head_seq % queue->header->capacity];
+    record->seq = queue->header->head_seq;
+    record->timestamp = reading->timestamp;
+    record->temperature = reading->temperature;
+    record->humidity = reading->humidity;
+    record->temperature_centi = (int16_t)reading->temperature_centi;
+    record->humidity_centi = (int16_t)reading->humidity_centi;
+    record->checksum = record_checksum(record);
+    
+    // Record first, then the header that makes it visible
+    sync_range(queue, record, sizeof(*record), MS_SYNC);
+    queue->header->head_seq++;
+    sync_range(queue, queue->header, sizeof(*queue->header), MS_SYNC);
+    
+    return TECHTEMP_OK;
+}
+
+/**
+ * Get the next readings waiting to be published
+ */
+int reading_queue_peek_unsent(reading_queue_t* queue, sensor_reading_t* readings, int max_count) {
+    if (!queue->header || !readings || max_count <= 0) {
+        return 0;
+    }
+    
+    if (queue->inflight_count >= READING_QUEUE_MAX_INFLIGHT) {
+        return 0;
+    }
+    
+    int count = 0;
+    for (uint64_t seq = queue->send_seq; seq < queue->header->head_seq && count < max_count; seq++, count++) {
+        const queue_record_t* record = &queue->records[seq % queue->header->capacity];
+        readings[count].temperature = record->temperature;
+        readings[count].humidity = record->humidity;
+        readings[count].temperature_centi = record->temperature_centi;
+        readings[count].humidity_centi = record->humidity_centi;
+        readings[count].timestamp = record->timestamp;
+        readings[count].seq = record->seq;
+        readings[count].valid = true;
+    }
+    
+    return count;
+}
+
+/**
+ * Record the message id of the readings just published
+ */
+void reading_queue_mark_sent(reading_queue_t* queue, int mid, int count) {
+    if (!queue->header || count <= 0 || queue->inflight_count >= READING_QUEUE_MAX_INFLIGHT ||
+        queue->send_seq + (uint64_t)count > queue->header->head_seq) {
+        return;
+    }
+    
+    reading_queue_inflight_t* entry = &queue->inflight[(queue->inflight_first + queue->inflight_count) % READING_QUEUE_MAX_INFLIGHT];
+    entry->mid = mid;
+    entry->count = (uint32_t)count;
+    entry->acked = (mid == queue->early_ack_mid);
+    queue->early_ack_mid = -1;
+    queue->inflight_count++;
+    queue->send_seq += (uint64_t)count;
+    
+    retire_acked(queue);
+}
+
+/**
+ * Retire the readings acknowledged by the broker
+ */
+bool reading_queue_ack(reading_queue_t* queue, int mid) {
+    if (!queue->header) {
+        return false;
+    }
+    
+    for (int i = 0; i < queue->inflight_count; i++) {
+        reading_queue_inflight_t* entry = &queue->inflight[(queue->inflight_first + i) % READING_QUEUE_MAX_INFLIGHT];
+        if (entry->mid == mid) {
+            entry->acked = true;
+            retire_acked(queue);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Remember an acknowledgement delivered inside the publish call
+ */
+void reading_queue_ack_unsent(reading_queue_t* queue, int mid) {
+    // Not sent yet from our point of view (QoS 0 callback inside publish)
+    queue->early_ack_mid = mid;
+}
+
+/**
+ * Forget in-flight state after a disconnection
+ */
+void reading_queue_rewind(reading_queue_t* queue) {
+    if (!queue->header) {
+        return;
+    }
+    
+    queue->send_seq = queue->header->tail_seq;
+    queue->early_ack_mid = -1;
+    queue->inflight_first = 0;
+    queue->inflight_count = 0;
+}
+
+/**
+ * Get the number of readings not yet published
+ */
+uint32_t reading_queue_unsent(const reading_queue_t* queue) {
+    if (!queue->header) {
+        return 0;
+    }
+    return (uint32_t)(queue->header->head_seq - queue->send_seq);
+}
+
+/**
+ * Get the number of readings not yet acknowledged
+ */
+uint32_t reading_queue_depth(const reading_queue_t* queue) {
+    if (!queue->header) {
+        return 0;
+    }
+    return (uint32_t)(queue->header->head_seq - queue->header->tail_seq);
+}
+
+/**
+ * Get the number of readings dropped because the queue was full
+ */
+uint64_t reading_queue_dropped(const reading_queue_t* queue) {
+    return queue->header ? queue->header->dropped : 0;
+}
+
+/**
+ * Flush and close the queue
+ */
+void reading_queue_close(reading_queue_t* queue) {
+    if (!queue->mapping) {
+        return;  // Never opened (or open failed)
+    }
+    
+    if (queue->fd != -1) {
+        sync_range(queue, queue->mapping, queue->mapping_size, MS_SYNC);
+    }
+    munmap(queue->mapping, queue->mapping_size);
+    queue->mapping = NULL;
+    
+    if (queue->fd != -1) {
+        close(queue->fd);
+        queue->fd = -1;
+    }
+    
+    queue->header = NULL;
+    queue->records = NULL;
+    queue->mapping_size = 0;
+    queue->send_seq = 0;
+}
+
+// Internal helper functions
+
+static uint32_t record_checksum(const queue_record_t* record) {
+    const uint8_t* bytes = (const uint8_t*)record;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(queue_record_t, checksum); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void sync_range(const reading_queue_t* queue, const void* addr, size_t length, int flags) {
+    if (queue->fd == -1) {
+        return;  // Memory-only queue
+    }
+    
+    // msync() needs a page-aligned start address
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(page - 1);
+    msync((void*)start, length + ((uintptr_t)addr - start), flags);
+}
+
+static void init_header(reading_queue_t* queue, uint32_t capacity) {
+    memset(queue->header, 0, sizeof(*queue->header));
+    queue->header->magic = READING_QUEUE_MAGIC;
+    queue->header->version = READING_QUEUE_VERSION;
+    queue->header->capacity = capacity;
+    queue->header->record_size = sizeof(queue_record_t);
+    reading_queue_rewind(queue);
+}
+
+static void recover(reading_queue_t* queue) {
+    // Sanity checks on a header written by a previous run
+    if (queue->header->tail_seq > queue->header->head_seq ||
+        queue->header->head_seq - queue->header->tail_seq > queue->header->capacity) {
+        LOG_WARN_F("Reading queue header inconsistent, discarding content");
+        queue->header->tail_seq = queue->header->head_seq;
+    }
+    
+    // Keep the longest valid run from the tail (a torn append ends it)
+    for (uint64_t seq = queue->header->tail_seq; seq < queue->header->head_seq; seq++) {
+        const queue_record_t* record = &queue->records[seq % queue->header->capacity];
+        if (record->seq != seq || record->checksum != record_checksum(record)) {
+            LOG_WARN_F("Reading queue truncated at record %llu (torn write)",
+                       (unsigned long long)seq);
+            queue->header->head_seq = seq;
+            break;
+        }
+    }
+    
+    reading_queue_rewind(queue);
+}
+
+static void migrate_v1(reading_queue_t* queue) {
+    // Version 1 records had no fixed-point values: derive them once
+    for (uint64_t seq = queue->header->tail_seq; seq < queue->header->head_seq; seq++) {
+        queue_record_t* record = &queue->records[seq % queue->header->capacity];
+        record->temperature_centi = (int16_t)lroundf(record->temperature * 100.0f);
+        record->humidity_centi = (int16_t)lroundf(record->humidity * 100.0f);
+        record->checksum = record_checksum(record);
+    }
+    
+    queue->header->version = READING_QUEUE_VERSION;
+    sync_range(queue, queue->mapping, queue->mapping_size, MS_SYNC);
+    LOG_INFO_F("Reading queue upgraded to version %d", READING_QUEUE_VERSION);
+}
+
+static void retire_acked(reading_queue_t* queue) {
+    uint64_t tail = queue->header->tail_seq;
+    while (queue->inflight_count > 0 && queue->inflight[queue->inflight_first].acked) {
+        tail += queue->inflight[queue->inflight_first].count;
+        pop_inflight(queue);
+    }
+    
+    if (tail != queue->header->tail_seq) {
+        metric_add(published_metric, (int64_t)(tail - queue->header->tail_seq));
+        queue->header->tail_seq = tail;
+        // Losing a retire only replays an idempotent reading: no need to wait
+        sync_range(queue, queue->header, sizeof(*queue->header), MS_ASYNC);
+    }
+}
+
+static void pop_inflight(reading_queue_t* queue) {
+    queue->inflight_first = (queue->inflight_first + 1) % READING_QUEUE_MAX_INFLIGHT;
+    queue->inflight_count--;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file schedule.c
+ * @brief Fleet-wide sampling schedule implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#define _DEFAULT_SOURCE  // Pour CLOCK_MONOTONIC
+#include "schedule.h"
+
+/**
+ * Compute the per-device phase offset within the interval
+ */
+uint32_t schedule_phase_offset_ms(const char* device_uid, uint32_t interval_ms) {
+    if (!device_uid || interval_ms == 0) {
+        return 0;
+    }
+    
+    // FNV-1a: stable across restarts and builds, well spread for similar UIDs
+    uint32_t hash = 2166136261u;
+    for (const char* c = device_uid; *c; c++) {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+    return hash % interval_ms;
+}
+
+/**
+ * Compute the next slot deadline strictly after now
+ */
+uint64_t schedule_next_slot_ms(uint32_t interval_ms, uint32_t offset_ms) {
+    uint64_t now_mono = schedule_monotonic_ms();
+    if (interval_ms == 0) {
+        return now_mono;
+    }
+    
+    // Slots are defined on the wall clock (same phase on every device)...
+    uint64_t now_real = get_timestamp_ms();
+    uint64_t slot_start = ((now_real - offset_ms) / interval_ms) * interval_ms + offset_ms;
+    uint64_t next_real = slot_start + interval_ms;
+    
+    // ...and waited for on the monotonic clock (immune to NTP steps while armed).
+    // +1 ms: both clocks are truncated to the millisecond, never fire early
+    return now_mono + (next_real - now_real) + 1;
+}
+
+/**
+ * Compute the next free-running deadline
+ */
+uint64_t schedule_next_period_ms(uint64_t previous_ms, uint32_t interval_ms, uint32_t* skipped) {
+    uint64_t now_ms = schedule_monotonic_ms();
+    uint64_t late = 0;
+    uint64_t next_ms = (previous_ms == 0) ? now_ms + 1 : previous_ms + interval_ms;
+    
+    // Overrun (or suspend): keep the phase, drop the periods already past
+    if (next_ms <= now_ms && interval_ms > 0) {
+        late = (now_ms - next_ms) / interval_ms + 1;
+        next_ms += late * interval_ms;
+    }
+    if (skipped) {
+        *skipped = (uint32_t)late;
+    }
+    return next_ms;
+}
+
+/**
+ * Get the monotonic clock in milliseconds
+ */
+uint64_t schedule_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * Get the monotonic clock in microseconds
+ */
+uint64_t schedule_monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
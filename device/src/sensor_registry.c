@@ -0,0 +1,311 @@
+/**
+ * @file sensor_registry.c
+ * @brief Sensor registry and TCA9548A multiplexer implementation
+ * @author TechTemp Project
+ * @date 2025-09-10
+ */
+
+#define _DEFAULT_SOURCE  // Pour O_CLOEXEC
+#include "sensor_registry.h"
+#include "mqtt_client.h"
+#include <math.h>
+#ifndef SIMULATION_MODE
+    #include <sys/ioctl.h>
+    #include <fcntl.h>
+    #ifdef __linux__
+        #include <linux/i2c-dev.h>
+    #else
+        #define I2C_SLAVE 0x0703
+    #endif
+#endif
+
+// Channel state of a multiplexer
+#define MUX_CHANNEL_NONE     -1     // All channels off
+#define MUX_CHANNEL_UNKNOWN  -2     // Last write failed: state must be rewritten
+
+// One TCA9548A
+typedef struct {
+    int i2c_bus;
+    uint8_t address;
+    int fd;
+    int channel;             // Open channel, MUX_CHANNEL_NONE or MUX_CHANNEL_UNKNOWN
+} mux_t;
+
+// Internal state
+static sensor_t sensors[MAX_SENSORS];
+static int sensor_count = 0;
+static mux_t muxes[MAX_SENSORS];
+static int mux_count = 0;
+static bool mux_emulated = false;  // Emulated sensors: channel selection is bookkeeping only
+
+// Internal helper functions
+static int compare_sensors(const void* a, const void* b);
+static int find_or_open_mux(int i2c_bus, uint8_t address);
+static int mux_write(mux_t* mux, int channel);
+static void open_queue(sensor_t* sensor, const device_config_t* config);
+
+/**
+ * Create the configured sensors
+ */
+int sensor_registry_init(const device_config_t* config) {
+    sensor_registry_cleanup();
+    mux_emulated = config->emulator_enabled;
+    
+    // Sorted copy: a pass in index order visits each mux channel once
+    sensor_config_t sorted[MAX_SENSORS];
+    memcpy(sorted, config->sensors, sizeof(sensor_config_t) * (size_t)config->sensor_count);
+    qsort(sorted, (size_t)config->sensor_count, sizeof(sensor_config_t), compare_sensors);
+    
+    int available = 0;
+    for (int i = 0; i < config->sensor_count; i++) {
+        const sensor_config_t* entry = &sorted[i];
+        sensor_t* sensor = &sensors[sensor_count++];
+        memset(sensor, 0, sizeof(*sensor));
+        
+        char id[MAX_DEVICE_UID_LEN];
+        memcpy(id, entry->id, sizeof(id));
+        id[sizeof(id) - 1] = '\0';
+        memcpy(sensor->id, id, sizeof(sensor->id));
+        sensor->i2c_bus = entry->i2c_bus;
+        sensor->i2c_address = entry->i2c_address;
+        sensor->mux_address = entry->mux_address;
+        sensor->mux_channel = entry->mux_channel;
+        sensor->mux_index = -1;
+        sensor->temp_offset = entry->temp_offset;
+        sensor->humidity_offset = entry->humidity_offset;
+        sensor->temp_offset_centi = (int32_t)lroundf(entry->temp_offset * 100.0f);
+        sensor->humidity_offset_centi = (int32_t)lroundf(entry->humidity_offset * 100.0f);
+        snprintf(sensor->topic, sizeof(sensor->topic), MQTT_TOPIC_TEMPLATE, config->home_id, id);
+        snprintf(sensor->batch_topic, sizeof(sensor->batch_topic), MQTT_BATCH_TOPIC_TEMPLATE,
+                 config->home_id, id);
+        snprintf(sensor->aggregate_topic, sizeof(sensor->aggregate_topic), MQTT_AGGREGATE_TOPIC_TEMPLATE,
+                 config->home_id, id);
+        for (int w = 0; w < config->aggregate_window_count; w++) {
+            aggregate_init(&sensor->aggregates[w], (uint32_t)config->aggregate_windows[w]);
+        }
+        sensor->aggregate_count = config->aggregate_window_count;
+        
+        // Queue first: an unavailable sensor still drains its backlog
+        open_queue(sensor, config);
+        
+        if (sensor->mux_address != 0) {
+            sensor->mux_index = find_or_open_mux(sensor->i2c_bus, sensor->mux_address);
+            if (sensor->mux_index < 0) {
+                LOG_WARN_F("⚠️  Sensor %s unavailable: mux 0x%02X not reachable", sensor->id, sensor->mux_address);
+                continue;
+            }
+            LOG_INFO_F("Initializing sensor %s (bus %d, 0x%02X via mux 0x%02X channel %d)...", sensor->id,
+                       sensor->i2c_bus, sensor->i2c_address, sensor->mux_address, sensor->mux_channel);
+        } else {
+            LOG_INFO_F("Initializing sensor %s (bus %d, 0x%02X)...", sensor->id,
+                       sensor->i2c_bus, sensor->i2c_address);
+        }
+        
+        if (sensor_select(sensor) != TECHTEMP_OK) {
+            LOG_WARN_F("⚠️  Sensor %s unavailable: cannot select its mux channel", sensor->id);
+            continue;
+        }
+        
+        if (aht20_init(&sensor->driver, sensor->i2c_bus, sensor->i2c_address) != TECHTEMP_OK) {
+            LOG_WARN_F("⚠️  Sensor %s unavailable: %s", sensor->id, aht20_get_error(&sensor->driver));
+            aht20_cleanup(&sensor->driver);
+            continue;
+        }
+        
+        sensor->available = true;
+        available++;
+    }
+    
+    if (available == 0) {
+        LOG_ERROR_F("No sensor available (%d configured)", sensor_count);
+        return TECHTEMP_ERROR;
+    }
+    
+    LOG_INFO_F("%d of %d sensors available", available, sensor_count);
+    return TECHTEMP_OK;
+}
+
+/**
+ * Get the number of registered sensors
+ */
+int sensor_registry_count(void) {
+    return sensor_count;
+}
+
+/**
+ * Get a registered sensor
+ */
+sensor_t* sensor_registry_get(int index) {
+    if (index < 0 || index >= sensor_count) {
+        return NULL;
+    }
+    return &sensors[index];
+}
+
+/**
+ * Route the I2C bus to a sensor
+ */
+int sensor_select(sensor_t* sensor) {
+    // Close the channels of the other muxes on this bus: a sensor behind
+    // them may answer at the same address
+    for (int i = 0; i < mux_count; i++) {
+        mux_t* mux = &muxes[i];
+        if (i == sensor->mux_index || mux->i2c_bus != sensor->i2c_bus || mux->channel == MUX_CHANNEL_NONE) {
+            continue;
+        }
+        if (mux_write(mux, MUX_CHANNEL_NONE) != TECHTEMP_OK) {
+            return TECHTEMP_ERROR;
+        }
+    }
+    
+    if (sensor->mux_index < 0) {
+        return TECHTEMP_OK;
+    }
+    
+    mux_t* mux = &muxes[sensor->mux_index];
+    if (mux->channel == sensor->mux_channel) {
+        return TECHTEMP_OK;
+    }
+    return mux_write(mux, sensor->mux_channel);
+}
+
+/**
+ * Close the drivers, queues and multiplexers
+ */
+void sensor_registry_cleanup(void) {
+    for (int i = 0; i < sensor_count; i++) {
+        if (sensors[i].available) {
+            const aht20_stats_t* stats = aht20_get_stats(&sensors[i].driver);
+            LOG_INFO_F("Sensor %s: %u readings, %u CRC errors, %u status errors, %u I/O errors, "
+                       "%u timeouts, %u retries, %u failed cycles, %u resets, %u suppressed", sensors[i].id,
+                       stats->readings, stats->crc_errors, stats->status_errors, stats->io_errors,
+                       stats->timeouts, sensors[i].retries, sensors[i].failed_cycles, stats->resets,
+                       sensors[i].suppressed);
+            for (int w = 0; w < sensors[i].aggregate_count; w++) {
+                if (sensors[i].aggregates[w].dropped > 0) {
+                    LOG_WARN_F("⚠️  Sensor %s: %u aggregates of %u s lost while MQTT was down", sensors[i].id,
+                               sensors[i].aggregates[w].dropped, sensors[i].aggregates[w].window_s);
+                }
+            }
+            aht20_cleanup(&sensors[i].driver);
+        }
+        reading_queue_close(&sensors[i].queue);
+    }
+    sensor_count = 0;
+    
+    for (int i = 0; i < mux_count; i++) {
+        // Leave the bus as found: all channels off
+        if (muxes[i].channel != MUX_CHANNEL_NONE) {
+            mux_write(&muxes[i], MUX_CHANNEL_NONE);
+        }
+#ifndef SIMULATION_MODE
+        if (muxes[i].fd >= 0) {
+            close(muxes[i].fd);
+        }
+#endif
+    }
+    mux_count = 0;
+}
+
+// Internal helper functions
+
+static int compare_sensors(const void* a, const void* b) {
+    const sensor_config_t* left = a;
+    const sensor_config_t* right = b;
+    
+    if (left->i2c_bus != right->i2c_bus) {
+        return left->i2c_bus < right->i2c_bus ? -1 : 1;
+    }
+    if (left->mux_address != right->mux_address) {
+        return left->mux_address < right->mux_address ? -1 : 1;
+    }
+    if (left->mux_channel != right->mux_channel) {
+        return left->mux_channel < right->mux_channel ? -1 : 1;
+    }
+    if (left->i2c_address != right->i2c_address) {
+        return left->i2c_address < right->i2c_address ? -1 : 1;
+    }
+    return 0;
+}
+
+static int find_or_open_mux(int i2c_bus, uint8_t address) {
+    for (int i = 0; i < mux_count; i++) {
+        if (muxes[i].i2c_bus == i2c_bus && muxes[i].address == address) {
+            return i;
+        }
+    }
+    
+    mux_t* mux = &muxes[mux_count];
+    mux->i2c_bus = i2c_bus;
+    mux->address = address;
+    mux->fd = -1;
+    mux->channel = MUX_CHANNEL_UNKNOWN;
+    
+    // No mux behind the emulator, even on a hardware build (CI box, x86 bench)
+    if (mux_emulated) {
+        mux->channel = MUX_CHANNEL_NONE;
+        LOG_DEBUG_F("Mux 0x%02X on bus %d emulated", address, i2c_bus);
+        return mux_count++;
+    }
+
+#ifndef SIMULATION_MODE
+    char i2c_device[20];
+    snprintf(i2c_device, sizeof(i2c_device), "/dev/i2c-%d", i2c_bus);
+    
+    mux->fd = open(i2c_device, O_RDWR | O_CLOEXEC);
+    if (mux->fd < 0) {
+        LOG_WARN_F("⚠️  Failed to open I2C device %s for mux 0x%02X: %s", i2c_device, address, strerror(errno));
+        return -1;
+    }
+    
+    if (ioctl(mux->fd, I2C_SLAVE, address) < 0) {
+        LOG_WARN_F("⚠️  Failed to configure mux address 0x%02X: %s", address, strerror(errno));
+        close(mux->fd);
+        return -1;
+    }
+#endif
+
+    // Known state: all channels off (also checks that the mux answers)
+    if (mux_write(mux, MUX_CHANNEL_NONE) != TECHTEMP_OK) {
+#ifndef SIMULATION_MODE
+        close(mux->fd);
+#endif
+        return -1;
+    }
+    
+    LOG_DEBUG_F("Mux 0x%02X on bus %d ready", address, i2c_bus);
+    return mux_count++;
+}
+
+static int mux_write(mux_t* mux, int channel) {
+    uint8_t control = (channel >= 0) ? (uint8_t)(1u << channel) : 0;
+
+#ifndef SIMULATION_MODE
+    if (!mux_emulated && write(mux->fd, &control, 1) != 1) {
+        LOG_WARN_F("⚠️  Mux 0x%02X on bus %d: write failed: %s", mux->address, mux->i2c_bus, strerror(errno));
+        mux->channel = MUX_CHANNEL_UNKNOWN;
+        return TECHTEMP_ERROR;
+    }
+#endif
+
+    LOG_DEBUG_F("Mux 0x%02X on bus %d: control 0x%02X", mux->address, mux->i2c_bus, control);
+    mux->channel = channel;
+    return TECHTEMP_OK;
+}
+
+static void open_queue(sensor_t* sensor, const device_config_t* config) {
+    // The sensor named after the device keeps the legacy queue file
+    char path[MAX_STRING_LEN + MAX_DEVICE_UID_LEN + 1] = "";
+    if (config->queue_file[0] != '\0') {
+        if (strcmp(sensor->id, config->device_uid) == 0) {
+            snprintf(path, sizeof(path), "%s", config->queue_file);
+        } else {
+            snprintf(path, sizeof(path), "%s.%s", config->queue_file, sensor->id);
+        }
+    }
+    
+    if (reading_queue_open(&sensor->queue, path, (uint32_t)config->queue_capacity) != TECHTEMP_OK) {
+        LOG_WARN_F("Persistent queue unavailable for %s, readings will not survive a restart", sensor->id);
+        reading_queue_open(&sensor->queue, NULL, (uint32_t)config->queue_capacity);
+    }
+}
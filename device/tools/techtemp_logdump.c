@@ -0,0 +1,266 @@
+/**
+ * @file techtemp_logdump.c
+ * @brief Offline formatter for TechTemp binary trace logs
+ * @author TechTemp Project
+ * @date 2025-09-10
+ *
+ * Prints the records of a trace file (log_trace_file) oldest first, in
+ * the same layout as the text log, with millisecond timestamps.
+ * Build with: make logdump
+ * Usage: techtemp-logdump <trace-file>
+ */
+
+#define _GNU_SOURCE  // Pour localtime_r()
+#include "log_trace.h"
+#include <stddef.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MESSAGE_MAX 1024
+
+// Wall-clock reference from the last epoch record
+typedef struct {
+    bool valid;
+    uint64_t monotonic_ns;
+    uint64_t realtime_ms;
+} clock_reference_t;
+
+static const char* level_name(uint8_t level) {
+    switch (level) {
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        case LOG_LEVEL_INFO:  return "INFO ";
+        case LOG_LEVEL_WARN:  return "WARN ";
+        case LOG_LEVEL_ERROR: return "ERROR";
+        default:              return "UNKN ";
+    }
+}
+
+static uint16_t get_u16(const uint8_t* buffer) {
+    return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+static uint64_t get_u64(const uint8_t* buffer) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | buffer[i];
+    }
+    return value;
+}
+
+static void format_timestamp(char* buffer, size_t size, const clock_reference_t* reference, uint64_t timestamp_ns) {
+    if (!reference->valid) {
+        // No clock reference yet: time since boot
+        snprintf(buffer, size, "+%llu.%06llu",
+                 (unsigned long long)(timestamp_ns / 1000000000ull),
+                 (unsigned long long)(timestamp_ns % 1000000000ull / 1000));
+        return;
+    }
+    
+    int64_t offset_ms = ((int64_t)timestamp_ns - (int64_t)reference->monotonic_ns) / 1000000;
+    uint64_t realtime_ms = reference->realtime_ms + (uint64_t)offset_ms;
+    time_t seconds = (time_t)(realtime_ms / 1000);
+    struct tm local_tm;
+    char text[32] = "1970-01-01 00:00:00";
+    if (localtime_r(&seconds, &local_tm)) {
+        strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local_tm);
+    }
+    snprintf(buffer, size, "%s.%03u", text, (unsigned)(realtime_ms % 1000));
+}
+
+/**
+ * Rebuild a message from its site format and the recorded arguments
+ * @return false if the arguments do not match the format
+ */
+static bool format_message(char* out, size_t size, const char* format, const uint8_t* args, size_t args_length) {
+    size_t written = 0;
+    size_t offset = 0;
+    log_trace_conversion_t conversion;
+    const char* text = format;
+    const char* next;
+    
+    #define APPEND(...) do { \
+        int n = snprintf(out + written, size - written, __VA_ARGS__); \
+        if (n > 0) written += ((size_t)n < size - written) ? (size_t)n : size - written - 1; \
+    } while (0)
+    
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wformat-nonliteral"
+    while ((next = log_trace_next_conversion(text, &conversion)) != NULL) {
+        APPEND("%.*s", (int)(conversion.start - text), text);
+        text = next;
+        
+        char spec[LOG_TRACE_FORMAT_MAX];
+        snprintf(spec, sizeof(spec), "%.*s", (int)conversion.length, conversion.start);
+        
+        if (conversion.kind == LOG_ARG_NONE) {
+            APPEND("%%");
+            continue;
+        }
+        
+        int stars[2] = {0, 0};
+        for (int i = 0; i < conversion.stars; i++) {
+            if (offset + 8 > args_length) {
+                return false;
+            }
+            stars[i] = (int)(int64_t)get_u64(args + offset);
+            offset += 8;
+        }
+        
+        // Pass the '*' arguments, then the value with the type the format expects
+        #define APPEND_VALUE(value) do { \
+            if (conversion.stars == 0) APPEND(spec, value); \
+            else if (conversion.stars == 1) APPEND(spec, stars[0], value); \
+            else APPEND(spec, stars[0], stars[1], value); \
+        } while (0)
+        
+        if (conversion.kind == LOG_ARG_STRING) {
+            if (offset + 1 > args_length || offset + 1 + args[offset] > args_length) {
+                return false;
+            }
+            char string[LOG_TRACE_STRING_MAX + 1];
+            size_t string_length = args[offset];
+            memcpy(string, args + offset + 1, string_length);
+            string[string_length] = '\0';
+            offset += 1 + string_length;
+            APPEND_VALUE(string);
+            continue;
+        }
+        
+        if (offset + 8 > args_length) {
+            return false;
+        }
+        uint64_t value = get_u64(args + offset);
+        offset += 8;
+        double number;
+        memcpy(&number, &value, sizeof(number));
+        
+        switch (conversion.kind) {
+            case LOG_ARG_INT:         APPEND_VALUE((int)(int64_t)value); break;
+            case LOG_ARG_UINT:        APPEND_VALUE((unsigned int)value); break;
+            case LOG_ARG_LONG:        APPEND_VALUE((long)(int64_t)value); break;
+            case LOG_ARG_ULONG:       APPEND_VALUE((unsigned long)value); break;
+            case LOG_ARG_LLONG:       APPEND_VALUE((long long)value); break;
+            case LOG_ARG_ULLONG:      APPEND_VALUE((unsigned long long)value); break;
+            case LOG_ARG_SIZE:        APPEND_VALUE((size_t)value); break;
+            case LOG_ARG_INTMAX:      APPEND_VALUE((intmax_t)value); break;
+            case LOG_ARG_PTRDIFF:     APPEND_VALUE((ptrdiff_t)(int64_t)value); break;
+            case LOG_ARG_POINTER:     APPEND_VALUE((void*)(uintptr_t)value); break;
+            case LOG_ARG_DOUBLE:      APPEND_VALUE(number); break;
+            case LOG_ARG_LONG_DOUBLE: APPEND_VALUE((long double)number); break;
+            default:                  return false;
+        }
+        #undef APPEND_VALUE
+    }
+    #pragma GCC diagnostic pop
+    
+    APPEND("%s", text);
+    #undef APPEND
+    return offset == args_length;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <trace-file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    
+    int fd = open(argv[1], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", argv[1], strerror(errno));
+        return EXIT_FAILURE;
+    }
+    
+    size_t sites_offset = sizeof(log_trace_header_t);
+    size_t ring_offset = sites_offset + LOG_TRACE_MAX_SITES * sizeof(log_trace_site_t);
+    if ((size_t)st.st_size < ring_offset) {
+        fprintf(stderr, "%s: not a trace log (too short)\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    
+    const uint8_t* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s: %s\n", argv[1], strerror(errno));
+        return EXIT_FAILURE;
+    }
+    
+    const log_trace_header_t* header = (const log_trace_header_t*)mapping;
+    const log_trace_site_t* sites = (const log_trace_site_t*)(mapping + sites_offset);
+    const uint8_t* ring = mapping + ring_offset;
+    
+    if (header->magic != LOG_TRACE_MAGIC || header->version != LOG_TRACE_VERSION ||
+        header->max_sites != LOG_TRACE_MAX_SITES || ring_offset + header->data_size != (size_t)st.st_size ||
+        header->tail >= header->data_size || header->used > header->data_size) {
+        fprintf(stderr, "%s: not a trace log or unsupported version\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    
+    clock_reference_t reference = { header->epoch_realtime_ms != 0,
+                                    header->epoch_monotonic_ns, header->epoch_realtime_ms };
+    uint64_t offset = header->tail;
+    uint64_t remaining = header->used;
+    unsigned long records = 0;
+    
+    while (remaining > 0) {
+        uint64_t to_end = header->data_size - offset;
+        const uint8_t* record = ring + offset;
+        
+        // End of the ring skipped by the writer
+        if (to_end < LOG_TRACE_RECORD_HEADER || get_u16(record) == LOG_TRACE_SITE_PADDING) {
+            if (to_end > remaining) {
+                break;
+            }
+            remaining -= to_end;
+            offset = 0;
+            continue;
+        }
+        
+        uint16_t site_id = get_u16(record);
+        uint16_t length = get_u16(record + 2);
+        if (length < LOG_TRACE_RECORD_HEADER || length > LOG_TRACE_RECORD_MAX ||
+            length > to_end || length > remaining) {
+            fprintf(stderr, "Corrupted record at offset %llu, stopping\n", (unsigned long long)offset);
+            break;
+        }
+        
+        uint64_t timestamp_ns = get_u64(record + 4);
+        const uint8_t* args = record + LOG_TRACE_RECORD_HEADER;
+        size_t args_length = length - LOG_TRACE_RECORD_HEADER;
+        
+        if (site_id == LOG_TRACE_SITE_EPOCH && args_length == 8) {
+            reference.valid = true;
+            reference.monotonic_ns = timestamp_ns;
+            reference.realtime_ms = get_u64(args);
+            char timestamp[48];
+            format_timestamp(timestamp, sizeof(timestamp), &reference, timestamp_ns);
+            printf("[%s] ----- trace started -----\n", timestamp);
+        } else if (site_id < header->site_count) {
+            const log_trace_site_t* site = &sites[site_id];
+            char timestamp[48];
+            char message[MESSAGE_MAX];
+            format_timestamp(timestamp, sizeof(timestamp), &reference, timestamp_ns);
+            if (!format_message(message, sizeof(message), site->format, args, args_length)) {
+                snprintf(message, sizeof(message), "<arguments do not match \"%s\">", site->format);
+            }
+            printf("[%s] %s %.*s:%u: %s\n", timestamp, level_name(site->level),
+                   (int)sizeof(site->file), site->file, site->line, message);
+            records++;
+        } else {
+            fprintf(stderr, "Unknown call site %u at offset %llu\n", site_id, (unsigned long long)offset);
+        }
+        
+        offset += length;
+        remaining -= length;
+        if (offset == header->data_size) {
+            offset = 0;
+        }
+    }
+    
+    fprintf(stderr, "%lu records, %u call sites, %llu calls not traced\n",
+            records, header->site_count, (unsigned long long)header->dropped);
+    munmap((void*)mapping, (size_t)st.st_size);
+    close(fd);
+    return EXIT_SUCCESS;
+}
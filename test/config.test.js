@@ -16,6 +16,7 @@ describe('Configuration Loading', () => {
     delete process.env.MQTT_USERNAME;
     delete process.env.MQTT_PASSWORD;
     delete process.env.TOPIC_READING_PATTERN;
+    delete process.env.TOPIC_BATCH_PATTERN;
   });
 
   afterEach(() => {
@@ -40,7 +41,8 @@ describe('Configuration Loading', () => {
         dbPath: './test.db',
         mqttUrl: 'mqtt://localhost:1883',
         httpPort: 3000,
-        topicReadingPattern: 'home/+/sensors/+/reading' // valeur par défaut
+        topicReadingPattern: 'home/+/sensors/+/reading', // valeur par défaut
+        topicBatchPattern: 'home/+/sensors/+/batch'
       });
     });
 
@@ -64,7 +66,8 @@ describe('Configuration Loading', () => {
         httpPort: 8080,
         mqttUsername: 'user123',
         mqttPassword: 'secret456',
-        topicReadingPattern: 'home/+/sensors/+/reading'
+        topicReadingPattern: 'home/+/sensors/+/reading',
+        topicBatchPattern: 'home/+/sensors/+/batch'
       });
     });
 
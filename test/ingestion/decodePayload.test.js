@@ -0,0 +1,86 @@
+/**
+ * @file Tests for MQTT payload decoding (JSON and compact binary)
+ */
+
+import { describe, it, expect } from 'vitest';
+import { decodePayload, decodeBinaryReadings, isBinaryPayload } from '../../backend/ingestion/decodePayload.js';
+
+// Vectors produced by the device encoder (format_readings_binary)
+const SINGLE_HEX = '010129f7b18ffe92332a098214';
+const BATCH_HEX = '010329f7b18ffe92332a098214e0d403dafd0f279f9c01fc080000';
+
+describe('Decode Payload - MQTT Payload Decoding', () => {
+  describe('JSON Payloads', () => {
+    it('should parse JSON payloads unchanged', () => {
+      // Arrange
+      const payload = Buffer.from('{"temperature_c":23.5,"humidity_pct":65.2,"ts":1757442988279}');
+
+      // Act
+      const result = decodePayload('home/home-001/sensors/temp001/reading', payload);
+
+      // Assert
+      expect(isBinaryPayload(payload)).toBe(false);
+      expect(result).toEqual({ temperature_c: 23.5, humidity_pct: 65.2, ts: 1757442988279 });
+    });
+
+    it('should reject invalid JSON', () => {
+      // Act & Assert
+      expect(() => decodePayload('home/home-001/sensors/temp001/reading', Buffer.from('{invalid'))).toThrow();
+    });
+  });
+
+  describe('Binary Payloads', () => {
+    it('should decode a single reading on the reading topic', () => {
+      // Arrange
+      const payload = Buffer.from(SINGLE_HEX, 'hex');
+
+      // Act
+      const result = decodePayload('home/home-001/sensors/temp001/reading', payload);
+
+      // Assert
+      expect(isBinaryPayload(payload)).toBe(true);
+      expect(result).toEqual({ temperature_c: 23.46, humidity_pct: 52.5, ts: 1757442988279, seq: 41 });
+    });
+
+    it('should decode a batch with timestamp deltas and consecutive sequence numbers', () => {
+      // Arrange
+      const payload = Buffer.from(BATCH_HEX, 'hex');
+
+      // Act
+      const result = decodePayload('home/home-001/sensors/temp001/batch', payload);
+
+      // Assert
+      expect(result).toEqual([
+        { temperature_c: 23.46, humidity_pct: 52.5, ts: 1757442988279, seq: 41 },
+        { temperature_c: -5.5, humidity_pct: 99.99, ts: 1757443018279, seq: 42 },
+        { temperature_c: 23, humidity_pct: 0, ts: 1757443008279, seq: 43 } // negative delta
+      ]);
+    });
+
+    it('should always return an array on the batch topic', () => {
+      // Act
+      const result = decodePayload('home/home-001/sensors/temp001/batch', Buffer.from(SINGLE_HEX, 'hex'));
+
+      // Assert
+      expect(result).toHaveLength(1);
+    });
+
+    it('should reject several readings on the reading topic', () => {
+      // Act & Assert
+      expect(() => decodePayload('home/home-001/sensors/temp001/reading', Buffer.from(BATCH_HEX, 'hex')))
+        .toThrow('Binary reading payload must carry one reading (got 3)');
+    });
+
+    it('should reject truncated payloads and trailing bytes', () => {
+      // Act & Assert
+      expect(() => decodeBinaryReadings(Buffer.from(SINGLE_HEX.slice(0, -2), 'hex'))).toThrow('Binary payload truncated');
+      expect(() => decodeBinaryReadings(Buffer.from(SINGLE_HEX + '00', 'hex'))).toThrow('Binary payload has trailing bytes');
+      expect(() => decodeBinaryReadings(Buffer.from('01002900', 'hex'))).toThrow('Binary payload carries no reading');
+    });
+
+    it('should reject unknown versions', () => {
+      // Act & Assert
+      expect(() => decodeBinaryReadings(Buffer.from('020100', 'hex'))).toThrow('Unsupported binary payload version: 2');
+    });
+  });
+});
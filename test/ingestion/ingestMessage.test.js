@@ -267,4 +267,106 @@ describe('Ingest Message - MQTT Pipeline Integration', () => {
       expect(end - start).toBeLessThan(10); // 10ms should be plenty for mocked calls
     });
   });
+
+  describe('Batch Payloads', () => {
+    const topic = 'home/home-001/sensors/temp001/batch';
+    const payload = [
+      { temperature_c: 23.5, humidity_pct: 65.2, ts: 1757442988279 },
+      { temperature_c: 23.6, humidity_pct: 65.0, ts: 1757443018279 },
+      { temperature_c: 23.7, humidity_pct: 64.9, ts: 1757443048279 }
+    ];
+
+    beforeEach(() => {
+      mockRepository.devices.findByUid.mockResolvedValue({ device_uid: 'temp001' });
+      mockRepository.devices.getCurrentPlacement.mockResolvedValue({ room_id: 'living-room' });
+      mockRepository.devices.updateLastSeen.mockResolvedValue({});
+    });
+
+    it('should insert every reading of a batch', async () => {
+      // Arrange
+      let rowId = 100;
+      mockRepository.readings.create.mockImplementation(async () => ({ lastInsertRowid: ++rowId }));
+
+      // Act
+      const result = await ingestMessage(topic, payload, {}, mockRepository);
+
+      // Assert
+      expect(result.success).toBe(true);
+      expect(result.deviceId).toBe('temp001');
+      expect(result.readings).toHaveLength(3);
+      expect(result.insertIds).toEqual([101, 102, 103]);
+      expect(result.insertId).toBe(103);
+      expect(result.duplicates).toBe(0);
+      expect(mockRepository.readings.create).toHaveBeenCalledTimes(3);
+      expect(mockRepository.readings.create).toHaveBeenNthCalledWith(2, expect.objectContaining({
+        uid: 'temp001',
+        room_id: 'living-room',
+        temperature: 23.6,
+        source: 'mqtt'
+      }));
+      expect(mockRepository.devices.getCurrentPlacement).toHaveBeenCalledTimes(1);
+      expect(mockRepository.devices.updateLastSeen).toHaveBeenCalledWith('temp001', new Date(1757443048279).toISOString());
+    });
+
+    it('should count replayed readings as duplicates', async () => {
+      // Arrange
+      const duplicateError = Object.assign(new Error('UNIQUE constraint failed: readings_raw.msg_id'), {
+        code: 'SQLITE_CONSTRAINT_UNIQUE'
+      });
+      mockRepository.readings.create
+        .mockRejectedValueOnce(duplicateError)
+        .mockResolvedValueOnce({ lastInsertRowid: 7 })
+        .mockResolvedValueOnce({ lastInsertRowid: 8 });
+
+      // Act
+      const result = await ingestMessage(topic, payload, {}, mockRepository);
+
+      // Assert
+      expect(result.success).toBe(true);
+      expect(result.duplicates).toBe(1);
+      expect(result.insertIds).toEqual([7, 8]);
+    });
+
+    it('should treat a replayed single reading as a duplicate', async () => {
+      // Arrange
+      const duplicateError = Object.assign(new Error('UNIQUE constraint failed: readings_raw.msg_id'), {
+        code: 'SQLITE_CONSTRAINT_UNIQUE'
+      });
+      mockRepository.readings.create.mockRejectedValueOnce(duplicateError);
+
+      // Act
+      const result = await ingestMessage('home/home-001/sensors/temp001/reading', payload[0], {}, mockRepository);
+
+      // Assert
+      expect(result.success).toBe(true);
+      expect(result.duplicate).toBe(true);
+      expect(result.insertId).toBeNull();
+      expect(mockRepository.devices.updateLastSeen).not.toHaveBeenCalled();
+    });
+
+    it('should still fail a single reading on other database errors', async () => {
+      // Arrange
+      mockRepository.readings.create.mockRejectedValueOnce(new Error('SQLITE_BUSY: database is locked'));
+
+      // Act & Assert
+      await expect(ingestMessage('home/home-001/sensors/temp001/reading', payload[0], {}, mockRepository))
+        .rejects.toThrow('database is locked');
+    });
+
+    it('should reject a batch published on the single reading topic', async () => {
+      // Act & Assert
+      await expect(ingestMessage('home/home-001/sensors/temp001/reading', payload, {}, mockRepository))
+        .rejects.toThrow();
+      expect(mockRepository.readings.create).not.toHaveBeenCalled();
+    });
+
+    it('should reject a batch from an unknown device', async () => {
+      // Arrange
+      mockRepository.devices.findByUid.mockResolvedValue(null);
+
+      // Act & Assert
+      await expect(ingestMessage(topic, payload, {}, mockRepository))
+        .rejects.toThrow('Device with UID temp001 not found');
+    });
+  });
 });
@@ -4,7 +4,7 @@
  */
 
 import { describe, it, expect } from 'vitest';
-import { validateReading } from '../../backend/ingestion/validateReading.js';
+import { validateReading, validateReadingBatch, MAX_BATCH_READINGS } from '../../backend/ingestion/validateReading.js';
 
 describe('Validate Reading - MQTT Payload Validation', () => {
 
@@ -295,4 +295,53 @@ describe('Validate Reading - MQTT Payload Validation', () => {
       expect(() => validateReading(payload)).toThrow(/temperature.*must.*be.*number/i);
     });
   });
+
+  describe('Batch Payloads', () => {
+    it('should validate every reading of a batch in order', () => {
+      // Arrange
+      const payload = [
+        { temperature_c: 23.7, humidity_pct: 52.5, ts: 1725427200000 },
+        { temperature_c: 23.8, humidity_pct: 52.4, ts: 1725427230000 }
+      ];
+
+      // Act
+      const result = validateReadingBatch(payload);
+
+      // Assert
+      expect(result).toHaveLength(2);
+      expect(result[0].temperature).toBe(23.7);
+      expect(result[1].temperature).toBe(23.8);
+      expect(result[1].ts).toBe(new Date(1725427230000).toISOString());
+    });
+
+    it('should reject non-array and empty batches', () => {
+      // Act & Assert
+      expect(() => validateReadingBatch({ temperature_c: 23.7, humidity_pct: 52.5, ts: 1725427200000 })).toThrow('Batch payload must be an array');
+      expect(() => validateReadingBatch([])).toThrow('Batch payload cannot be empty');
+      expect(() => validateReadingBatch(null)).toThrow('Payload is required');
+    });
+
+    it('should reject batches larger than the limit', () => {
+      // Arrange
+      const payload = Array.from({ length: MAX_BATCH_READINGS + 1 }, () => ({
+        temperature_c: 20.0,
+        humidity_pct: 50.0,
+        ts: 1725427200000
+      }));
+
+      // Act & Assert
+      expect(() => validateReadingBatch(payload)).toThrow(/too large/);
+    });
+
+    it('should report the index of the invalid reading', () => {
+      // Arrange
+      const payload = [
+        { temperature_c: 23.7, humidity_pct: 52.5, ts: 1725427200000 },
+        { temperature_c: 23.8, humidity_pct: 150.0, ts: 1725427230000 }
+      ];
+
+      // Act & Assert
+      expect(() => validateReadingBatch(payload)).toThrow(/^Reading 1: Humidity out of valid range/);
+    });
+  });
 });